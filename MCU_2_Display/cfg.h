@@ -24,10 +24,12 @@ typedef enum {
 } mcu_state_t;
 
 typedef enum {
+	UPDATING_INFO_RECORD,
+	UPDATING_INFO_MULTIPLE,
 	UPDATING_INFO_START_TIME,
 	UPDATING_INFO_END_TIME,
-	UPDATING_INFO_OWNER_NAME,
 	UPDATING_INFO_OCCUPATION_STATUS,
+	UPDATING_INFO_OWNER_NAME,
 	UPDATING_INFO_FINISHED
 } updating_state_t;
 
@@ -43,6 +45,21 @@ updating_state_t curr_upd_state;
 //#define LOW_POWER_MODE LOW_POWER_HIBERNATE
 #define LOW_POWER_MODE LOW_POWER_DEEP_SLEEP
 
+/* Source of the bookings: read from the GATT server of the hub after a
+   connection, or taken from its advertising without connecting, with the
+   connection as a fallback when no booking is broadcast */
+#define BOOKING_SOURCE_GATT 1
+#define BOOKING_SOURCE_ADV 2
+
+#define BOOKING_SOURCE BOOKING_SOURCE_GATT
+//#define BOOKING_SOURCE BOOKING_SOURCE_ADV
+
+/* AES-128 key of the booking broadcast, shared with the hub. No key is 
+   shipped: BOOKING_SOURCE_ADV does not build until the key of the hub is
+   provisioned here or on the compiler command line, as
+   #define BOOKING_ADV_KEY {0x..u, <16 bytes>} */
+//#define BOOKING_ADV_KEY
+
 bool mcwdt_intr_flag;
 bool gpio_intr_flag;
 
@@ -0,0 +1,56 @@
+/******************************************************************************
+* File Name: cy_eink_assets.h
+*
+* Description: This file contains the structure and the format of compressed
+*              1-bpp image assets, which are decompressed into frame buffers
+*              by Cy_EINK_AssetToFrameBuffer().
+*
+* Hardware Dependency: CY8CKIT-028-EPD E-INK Display Shield
+*
+********************************************************************************/
+/******************************************************************************
+* Assets are generated from PNG or PBM images by the converter in 
+* tools/eink_asset. The pixels of an asset are coded from left to right and 
+* from top to bottom, as a stream that runs on from one row to the next. Each
+* code is one of:
+*
+*  0ppppppp           : literal of the next 7 pixels, leftmost pixel in bit 0
+*  10Xnnnnn           : run of n + 1 black (X = 0) or white (X = 1) pixels, 
+*                       n = 0 to 31
+*  11Xnnnnn nnnnnnnn  : run of n + 1 black (X = 0) or white (X = 1) pixels, 
+*                       n = 0 to 8191, most significant bits first
+*
+* A pixel bit is set for a white pixel and literals have the bit order of the
+* frame buffer, see CY_EINK_PIXEL_BIT(). Pixels coded past the end of the image
+* are ignored.
+*******************************************************************************/
+
+/* Include Guard */
+#ifndef CY_EINK_ASSETS_H
+#define CY_EINK_ASSETS_H
+
+/* Header file includes */
+#include "cycfg.h"
+
+/* Codes of the asset data */
+#define CY_EINK_ASSET_RUN               (uint8_t) (0x80u)
+#define CY_EINK_ASSET_RUN_LONG          (uint8_t) (0x40u)
+#define CY_EINK_ASSET_RUN_WHITE         (uint8_t) (0x20u)
+#define CY_EINK_ASSET_RUN_LENGTH        (uint8_t) (0x1Fu)
+#define CY_EINK_ASSET_LITERAL_PIXELS    (uint8_t) (7u)
+
+/* Structure that contains a compressed image */
+typedef struct
+{
+    /* Width of the image in pixels */
+    uint16_t width;
+    /* Height of the image in pixels */
+    uint16_t height;
+    /* Size of the compressed data in bytes */
+    uint16_t dataSize;
+    /* Pointer to the compressed data */
+    uint8_t const* data;
+}   cy_eink_asset_t;
+
+#endif  /* CY_EINK_ASSETS_H */
+/* [] END OF FILE */
@@ -0,0 +1,337 @@
+/******************************************************************************
+* File Name: cy_eink_benchmark.c
+*
+* Version: 1.10
+*
+* Description: This file contains the benchmark of the E-INK update types.
+*
+* Hardware Dependency: CY8CKIT-028-EPD E-INK Display Shield
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* The corpus follows the booking screen of the application: a title line and 
+* three lines of booking details. Text is drawn with stand-in glyphs, so a 
+* changed character changes the same pixels as real text would. The 
+* transitions are the clear to the first booking, a change of one field, a new
+* booking and the clear of the screen.
+*
+* Each update prints one line:
+*  {"transition":"one_field","mode":"partial","stages":[{"encode_cycles":...,
+*   "time_us":...,"passes":...,"lines":...}],"encode_cycles":...,
+*   "spi_bytes":...,"cs_transactions":...,"wall_us":...,"image_ok":true}
+* where encode_cycles counts the CPU cycles spent preparing the data lines, 
+* time_us and wall_us are measured by the E-INK timer and image_ok is only 
+* printed when a check function is given.
+*******************************************************************************/
+
+/* Header file includes */
+#include <eInk_Library/cy_eink_benchmark.h>
+
+#ifdef CY_EINK_BENCHMARK
+
+/* Size of a stand-in glyph in pixels */
+#define CY_EINK_BENCH_GLYPH_WIDTH   (uint16_t) (8u)
+#define CY_EINK_BENCH_GLYPH_HEIGHT  (uint16_t) (14u)
+
+/* Positions of the lines of the booking screen, as in eink_task.c */
+#define CY_EINK_BENCH_TITLE_Y       (uint16_t) (5u)
+#define CY_EINK_BENCH_TEXT_X        (uint16_t) (5u)
+#define CY_EINK_BENCH_DURATION_Y    (uint16_t) (53u)
+#define CY_EINK_BENCH_OWNER_Y       (uint16_t) (73u)
+#define CY_EINK_BENCH_STATUS_Y      (uint16_t) (93u)
+
+/* Number of frames of the corpus */
+#define CY_EINK_BENCH_FRAME_COUNT   (uint8_t)  (4u)
+
+/* Text of a booking screen */
+typedef struct
+{
+    char const* duration;
+    char const* owner;
+    char const* status;
+}   cy_eink_bench_screen_t;
+
+/* Transition of the corpus */
+typedef struct
+{
+    char const* name;
+    uint8_t     prevFrame;
+    uint8_t     newFrame;
+}   cy_eink_bench_transition_t;
+
+/* Booking screens of the corpus. Frame 0 is the cleared screen */
+cy_eink_bench_screen_t const static benchScreens[CY_EINK_BENCH_FRAME_COUNT - 1u] =
+{
+    {"Duration: 09:00 - 10:00", "Booked by: Alice Martin", "Status: Occupied"},
+    {"Duration: 09:00 - 10:30", "Booked by: Alice Martin", "Status: Occupied"},
+    {"Duration: 13:00 - 14:30", "Booked by: Bob Jones", "Status: Free"}
+};
+
+/* Transitions of the corpus */
+cy_eink_bench_transition_t const static benchTransitions[] =
+{
+    {"first_booking", 0u, 1u},
+    {"one_field",     1u, 2u},
+    {"new_booking",   2u, 3u},
+    {"clear",         3u, 0u}
+};
+
+/* Update types and their names in the output */
+cy_eink_update_t const static benchModes[] = {CY_EINK_PARTIAL, CY_EINK_FULL_2STAGE,
+                                              CY_EINK_FULL_4STAGE};
+char const static* const      benchModeNames[] = {"partial", "full_2stage", 
+                                                  "full_4stage"};
+
+/* Frames of the corpus */
+cy_eink_frame_t static        benchFrames[CY_EINK_BENCH_FRAME_COUNT][CY_EINK_FRAME_SIZE];
+
+/*******************************************************************************
+* Function Name: static void Cy_EINK_BenchDrawText(cy_eink_frame_t* frame, 
+*                                   uint16_t x, uint16_t y, char const* text)
+********************************************************************************
+*
+* Summary: Draws a line of stand-in glyphs in black. Each glyph is a pattern 
+*  derived from its character; spaces are left blank.
+*
+* Parameters:
+*  cy_eink_frame_t* frame : Frame to draw into
+*  uint16_t x             : Left pixel of the text
+*  uint16_t y             : Top pixel of the text
+*  char const* text       : Text to draw
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static void Cy_EINK_BenchDrawText(cy_eink_frame_t* frame, uint16_t x, 
+                                  uint16_t y, char const* text)
+{
+    uint16_t    row;
+    uint16_t    column;
+    uint16_t    pixelX;
+    uint8_t     pattern;
+    uint8_t     c;
+    
+    for (; (*text != '\0') && ((x + CY_EINK_BENCH_GLYPH_WIDTH) <= CY_EINK_WIDTH);
+         text++, x += CY_EINK_BENCH_GLYPH_WIDTH)
+    {
+        c = (uint8_t)*text;
+        if (c == (uint8_t)' ')
+        {
+            continue;
+        }
+        
+        /* Leave a blank row above and below, and a blank column each side */
+        for (row = 1u; row < (CY_EINK_BENCH_GLYPH_HEIGHT - 1u); row++)
+        {
+            pattern = (uint8_t)(((c * 0x9Du) ^ (row * 0x3Bu) ^ (c << (row % 5u))) &
+                                0x7Eu);
+            for (column = 0u; column < CY_EINK_BENCH_GLYPH_WIDTH; column++)
+            {
+                if ((pattern & CY_EINK_PIXEL_BIT(column)) != 0u)
+                {
+                    pixelX = x + column;
+                    frame[((y + row) * PV_EINK_HORIZONTAL_SIZE) + (pixelX >> 3u)] &=
+                        (uint8_t)~CY_EINK_PIXEL_BIT(pixelX);
+                }
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: static void Cy_EINK_BenchBuildCorpus(void)
+********************************************************************************
+*
+* Summary: Draws the frames of the corpus.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static void Cy_EINK_BenchBuildCorpus(void)
+{
+    char const* title = "Room booking status";
+    uint16_t    titleX = (CY_EINK_WIDTH - 
+                          (strlen(title) * CY_EINK_BENCH_GLYPH_WIDTH)) / 2u;
+    uint8_t     i;
+    
+    memset(benchFrames, PV_EINK_WHITE_PIXEL_BYTE, sizeof(benchFrames));
+    
+    for (i = 1u; i < CY_EINK_BENCH_FRAME_COUNT; i++)
+    {
+        Cy_EINK_BenchDrawText(benchFrames[i], titleX, CY_EINK_BENCH_TITLE_Y, 
+                              title);
+        Cy_EINK_BenchDrawText(benchFrames[i], CY_EINK_BENCH_TEXT_X, 
+                              CY_EINK_BENCH_DURATION_Y, 
+                              benchScreens[i - 1u].duration);
+        Cy_EINK_BenchDrawText(benchFrames[i], CY_EINK_BENCH_TEXT_X, 
+                              CY_EINK_BENCH_OWNER_Y, benchScreens[i - 1u].owner);
+        Cy_EINK_BenchDrawText(benchFrames[i], CY_EINK_BENCH_TEXT_X, 
+                              CY_EINK_BENCH_STATUS_Y, benchScreens[i - 1u].status);
+    }
+}
+
+/*******************************************************************************
+* Function Name: static bool Cy_EINK_BenchUpdate(
+*               cy_eink_bench_transition_t const* transition, uint8_t mode,
+*               cy_eink_bench_check_t check)
+********************************************************************************
+*
+* Summary: Shows a transition of the corpus with an update type and prints its
+*  cost.
+*
+* Parameters:
+*  cy_eink_bench_transition_t const* transition : Transition to show
+*  uint8_t mode                                 : Index of the update type
+*  cy_eink_bench_check_t check                  : Check function, or NULL
+*
+* Return:
+*  bool : false if the check failed
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static bool Cy_EINK_BenchUpdate(cy_eink_bench_transition_t const* transition,
+                                uint8_t mode, cy_eink_bench_check_t check)
+{
+    pv_eink_bench_stage_t const*    stages;
+    uint8_t     stageCount;
+    uint8_t     i;
+    uint32_t    encodeCycles = 0u;
+    uint32_t    wallTime = 0u;
+    uint32_t    spiBytes;
+    uint32_t    spiTransactions;
+    bool        imageOk = true;
+    
+    Pv_EINK_BenchReset();
+    Cy_EINK_ResetSPICounters();
+    
+    Cy_EINK_ShowFrame(benchFrames[transition->prevFrame], 
+                      benchFrames[transition->newFrame], benchModes[mode], false);
+    
+    Cy_EINK_GetSPICounters(&spiBytes, &spiTransactions);
+    stageCount = Pv_EINK_BenchStages(&stages);
+    
+    printf("{\"transition\":\"%s\",\"mode\":\"%s\",\"stages\":[", 
+           transition->name, benchModeNames[mode]);
+    for (i = 0u; i < stageCount; i++)
+    {
+        printf("%s{\"encode_cycles\":%lu,\"time_us\":%lu,\"passes\":%u,"
+               "\"lines\":%u}", (i == 0u) ? "" : ",",
+               (unsigned long)stages[i].encodeCycles, 
+               (unsigned long)stages[i].stageTime,
+               (unsigned int)stages[i].passCount, 
+               (unsigned int)stages[i].lineCount);
+        encodeCycles += stages[i].encodeCycles;
+        wallTime += stages[i].stageTime;
+    }
+    printf("],\"encode_cycles\":%lu,\"spi_bytes\":%lu,\"cs_transactions\":%lu,"
+           "\"wall_us\":%lu", (unsigned long)encodeCycles, 
+           (unsigned long)spiBytes, (unsigned long)spiTransactions, 
+           (unsigned long)wallTime);
+    
+    if (check != NULL)
+    {
+        imageOk = check(benchFrames[transition->prevFrame], 
+                        benchFrames[transition->newFrame]);
+        printf(",\"image_ok\":%s", imageOk ? "true" : "false");
+    }
+    printf("}\r\n");
+    
+    return(imageOk);
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_BenchmarkRun(cy_eink_bench_check_t check)
+********************************************************************************
+*
+* Summary: Shows every transition of the corpus with every update type and 
+*  prints the cost of each update. Cy_EINK_Start() must have been called; the
+*  display is powered for the run and turned off at its end.
+*
+* Parameters:
+*  cy_eink_bench_check_t check : Function called after each update to check 
+*                                the display content, or NULL
+*
+* Return:
+*  bool : false if the display could not be powered or a check failed
+*
+* Side Effects:
+*  Takes about a minute on the kit.
+*
+*******************************************************************************/
+bool Cy_EINK_BenchmarkRun(cy_eink_bench_check_t check)
+{
+    uint8_t     transition;
+    uint8_t     mode;
+    bool        result = true;
+    
+    Cy_EINK_BenchBuildCorpus();
+    
+    if (!Cy_EINK_Power(CY_EINK_ON))
+    {
+        printf("{\"error\":\"power_on\"}\r\n");
+        return(false);
+    }
+    
+    for (transition = 0u; 
+         transition < (sizeof(benchTransitions) / sizeof(benchTransitions[0]));
+         transition++)
+    {
+        for (mode = 0u; mode < (sizeof(benchModes) / sizeof(benchModes[0])); 
+             mode++)
+        {
+            result &= Cy_EINK_BenchUpdate(&benchTransitions[transition], mode,
+                                          check);
+        }
+    }
+    
+    Cy_EINK_Power(CY_EINK_OFF);
+    
+    return(result);
+}
+
+#endif /* CY_EINK_BENCHMARK */
+
+/* [] END OF FILE */
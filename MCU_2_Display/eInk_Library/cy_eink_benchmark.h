@@ -0,0 +1,69 @@
+/******************************************************************************
+* File Name: cy_eink_benchmark.h
+*
+* Version: 1.10
+*
+* Description: This file contains function declarations and macro definitions 
+*              provided by the cy_eink_benchmark.c file.
+*
+* Hardware Dependency: CY8CKIT-028-EPD E-INK Display Shield
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* The benchmark shows a corpus of booking screen transitions with each update
+* type and prints the cost of every update as a line of JSON. It is compiled 
+* only when CY_EINK_BENCHMARK is defined, on the kit (DEFINES+=CY_EINK_BENCHMARK
+* in the Makefile, output on the debug UART) or on a host with the SPI capture
+* of tools/eink_host.
+*******************************************************************************/
+/* Include Guard */
+#ifndef CY_EINK_BENCHMARK_H
+#define CY_EINK_BENCHMARK_H
+
+/* Header file includes */
+#include <eInk_Library/cy_eink_library.h>
+
+#ifdef CY_EINK_BENCHMARK
+
+/* Function called after each update with the frames shown before and after 
+   it. Returns false if the display does not show the new frame */
+typedef bool (*cy_eink_bench_check_t)(cy_eink_frame_t const* prevFrame,
+                                      cy_eink_frame_t const* newFrame);
+
+/* Runs the benchmark */
+bool Cy_EINK_BenchmarkRun(cy_eink_bench_check_t check);
+
+#endif /* CY_EINK_BENCHMARK */
+
+#endif /* CY_EINK_BENCHMARK_H */
+/* [] END OF FILE */
@@ -75,6 +75,10 @@ typedef struct
     /* Color of the font : true  = black characters in white background
                            false = white characters in black background */
     bool color;
+    /* Width of each character from " " to "~" in pixels, used by 
+       Cy_EINK_DrawText(). NULL for a fixed width font, where all characters 
+       are xSize bytes wide */
+    uint8_t const* charWidth;
 }   cy_eink_font_t;
 
 /* Two predefined fonts provided by the library */
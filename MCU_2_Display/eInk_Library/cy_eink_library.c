@@ -57,8 +57,15 @@
 #define CY_EINK_ASCII_MIN  (uint8_t) (0x21)
 #define CY_EINK_ASCII_MAX  (uint8_t) (0x7E)
 
+/* First character of the width table of a font: " " */
+#define CY_EINK_ASCII_SPACE         (uint8_t) (0x20)
+
+/* Widest glyph drawn by Cy_EINK_DrawText, in pixels. A glyph row of up to 3
+   bytes, shifted by up to 7 pixels, still fits a 32-bit word */
+#define CY_EINK_TEXT_MAX_WIDTH      (uint8_t) (24u)
+
 /*******************************************************************************
-* Function Name: void Cy_EINK_Start(int8_t temperature)
+* Function Name: bool Cy_EINK_Start(int8_t temperature)
 ********************************************************************************
 *
 * Summary: Initialize the E-INK display hardware, starts the required PSoC 
@@ -70,19 +77,27 @@
 *  int8_t temperature : Ambient temperature in degree Celsius
 *
 * Return:
-*  None
+*  bool               : "True" if the hardware was initialized; "False" if the
+*                       E-INK timer could not be started
 *
 * Side Effects:
 *  Lower ambient temperature results in higher refresh times
 *
 *******************************************************************************/
-void Cy_EINK_Start(int8_t temperature)
+bool Cy_EINK_Start(int8_t temperature)
 {
+    /* Variable to store operation status */
+    pv_eink_status_t initStatus;
+    
     /* Initialize the E-INK display hardware and associated PSoC components */
-    Pv_EINK_Init();
+    initStatus = Pv_EINK_Init();
     
     /* Perform temperature compensation of E-INK parameters */
     Pv_EINK_SetTempFactor(temperature);
+    
+    /* If the operation was successful, return "true" */
+    return((initStatus == PV_EINK_RES_OK) ? CY_EINK_OPERATION_SUCCESS : 
+                                            CY_EINK_OPERATION_FAILURE);
 }
 
 /*******************************************************************************
@@ -266,6 +281,99 @@ void Cy_EINK_ShowFrame(cy_eink_frame_t* prevFrame, cy_eink_frame_t* newFrame,
     }
 }
 
+/*******************************************************************************
+* Function Name: void Cy_EINK_ShowRegion(cy_eink_frame_t* prevFrame, 
+*      cy_eink_frame_t* newFrame, cy_eink_rect_t const* rect,
+*      cy_eink_update_t updateType, bool powerCycle)
+********************************************************************************
+*
+* Summary: Updates a rectangular region of the E-INK display with the same 
+*  region of a frame/image stored in the flash or RAM.
+*
+*  Notes: The rectangle is widened to whole bytes (8 pixels) horizontally and
+*  clipped to the display. Only the lines of the region are sent to the display;
+*  the pixels outside the region are not altered. As with Cy_EINK_ShowFrame, 
+*  the previous frame must match the frame previously written to the display.
+*
+* Parameters:
+*  cy_eink_frame_t* prevFrame    : Pointer to the previous frame written on the display
+*  cy_eink_frame_t* newFrame     : Pointer to the new frame that need to be written
+*  cy_eink_rect_t const* rect    : Pixel rectangle to update
+*  cy_eink_update_t              : Full update (2/4 stages) or  Partial update
+*  bool powerCycle               : "true" for automatic power cycle, "false" for manual
+*
+*  Return:
+*  None
+*
+* Side Effects:
+*  This is a blocking function that can take as many as 2 seconds 
+*
+********************************************************************************/
+void Cy_EINK_ShowRegion(cy_eink_frame_t* prevFrame, cy_eink_frame_t* newFrame,
+                        cy_eink_rect_t const* rect, cy_eink_update_t updateType,
+                        bool powerCycle)
+{
+    /* Lines and bytes of the frames to drive */
+    pv_eink_region_t region;
+    
+    /* Ignore rectangles that are empty or outside the display */
+    if ((rect->x1 > rect->x2) || (rect->y1 > rect->y2) ||
+        (rect->x1 >= CY_EINK_WIDTH) || (rect->y1 >= CY_EINK_HEIGHT))
+    {
+        return;
+    }
+    
+    /* Clip the rectangle to byte and line boundaries of the display */
+    region.firstByte = (uint8_t)(rect->x1 >> 3u);
+    region.lastByte  = (uint8_t)(((rect->x2 < CY_EINK_WIDTH) ? 
+                                  rect->x2 : (CY_EINK_WIDTH - 1u)) >> 3u);
+    region.firstLine = (uint8_t)rect->y1;
+    region.lastLine  = (uint8_t)((rect->y2 < CY_EINK_HEIGHT) ? 
+                                 rect->y2 : (CY_EINK_HEIGHT - 1u));
+    
+    /* If power cycle operation requested, turn on E-INK power */
+    if (powerCycle)
+    {
+        Cy_EINK_Power(CY_EINK_ON);
+    }
+    /* Partial update stage */
+    if (updateType == CY_EINK_PARTIAL)
+    {
+        /* Update the region with changes from previous frame */
+        Pv_EINK_PartialStageRegionHandler(prevFrame, newFrame, &region);
+    }
+    /* Full update stages */
+    else if ((updateType == CY_EINK_FULL_4STAGE) || 
+             (updateType == CY_EINK_FULL_2STAGE))
+    {
+        /* Stage 1: update the region with the inverted version of the previous 
+           frame */
+        Pv_EINK_FullStageRegionHandler(prevFrame, PV_EINK_STAGE1, &region);
+        
+        /* Additional stages that reduce ghosting for a 4 stage full update */
+        if (updateType == CY_EINK_FULL_4STAGE)
+        {
+            /* Stage 2: update the region with all white pixels */
+            Pv_EINK_FullStageRegionHandler(prevFrame, PV_EINK_STAGE2, &region);
+            /* Stage 3: update the region with the inverted version of the new 
+               frame */
+            Pv_EINK_FullStageRegionHandler(newFrame, PV_EINK_STAGE3, &region);
+        }
+        
+        /* Stage 4: update the region with the new frame */
+        Pv_EINK_FullStageRegionHandler(newFrame, PV_EINK_STAGE4, &region);
+    }
+    else
+    {
+    }
+    
+    /* If power cycle operation requested, turn off E-INK power */
+    if (powerCycle)
+    {
+        Cy_EINK_Power(CY_EINK_OFF);
+    }
+}
+
 /*******************************************************************************
 * Function Name: void Cy_EINK_ImageToFrameBuffer(cy_eink_frame_t* frameBuffer,
 *                               cy_eink_frame_t* image, uint8_t* imgCoordinates)
@@ -500,4 +608,445 @@ void Cy_EINK_TextToFrameBuffer(cy_eink_frame_t* frameBuffer, char* string,
     }
 }
 
+/*******************************************************************************
+* Function Name: static uint8_t Cy_EINK_CharWidth(cy_eink_font_t const* fontInfo,
+*                                                 char character)
+********************************************************************************
+*
+* Summary: Returns the width of a character of a font, in pixels.
+*
+* Parameters:
+*  cy_eink_font_t const* fontInfo : Structure that stores font information
+*  char character                 : Character
+*
+* Return:
+*  uint8_t : Width of the character. Characters that the font does not contain
+*            are as wide as a space
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static uint8_t Cy_EINK_CharWidth(cy_eink_font_t const* fontInfo, char character)
+{
+    /* Fixed width font: all characters are as wide as the font data */
+    if (fontInfo->charWidth == NULL)
+    {
+        return (uint8_t)(fontInfo->xSize << 3u);
+    }
+    
+    if (((uint8_t)character > CY_EINK_ASCII_MAX) || 
+        ((uint8_t)character < CY_EINK_ASCII_MIN))
+    {
+        character = (char)CY_EINK_ASCII_SPACE;
+    }
+    
+    return fontInfo->charWidth[(uint8_t)character - CY_EINK_ASCII_SPACE];
+}
+
+/*******************************************************************************
+* Function Name: uint16_t Cy_EINK_TextWidth(char const* string, 
+*                                          cy_eink_font_t const* fontInfo)
+********************************************************************************
+*
+* Summary: Returns the width of a text drawn by Cy_EINK_DrawText(), for 
+*  instance to center or right-align it.
+*
+* Parameters:
+*  char const* string             : Pointer to the string
+*  cy_eink_font_t const* fontInfo : Structure that stores font information
+*
+* Return:
+*  uint16_t : Width of the text in pixels
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+uint16_t Cy_EINK_TextWidth(char const* string, cy_eink_font_t const* fontInfo)
+{
+    uint16_t width = 0u;
+    
+    for (; *string != '\0'; string++)
+    {
+        width += Cy_EINK_CharWidth(fontInfo, *string);
+    }
+    
+    return width;
+}
+
+/*******************************************************************************
+* Function Name: uint16_t Cy_EINK_DrawText(cy_eink_frame_t* frameBuffer, 
+*                char const* string, cy_eink_font_t const* fontInfo, 
+*                uint16_t x, uint16_t y)
+********************************************************************************
+*
+* Summary: Draws a text into a frame buffer at any pixel location. Each glyph
+*  covers its own width, from the font's width table, and the height of the 
+*  font; the glyph background is drawn as well, so a text overwrites the text 
+*  previously drawn at the same location. The text is clipped at the right and
+*  bottom edges of the display.
+*
+*  Notes: Unlike Cy_EINK_TextToFrameBuffer(), the location is in pixels rather
+*  than in font coordinates. Each glyph row is shifted to the pixel location in
+*  a 32-bit word and merged into the frame buffer bytes under a mask, and the 
+*  color of the font is resolved once per call. The font data has the bit 
+*  order of the frame buffer, see CY_EINK_PIXEL_BIT().
+*
+*  Glyphs wider than 24 pixels are drawn with their first 24 pixels.
+*
+*  This function does not need emWin and does not update the E-INK display. 
+*  After frame buffer update, use Cy_EINK_ShowFrame() or Cy_EINK_ShowRegion() 
+*  to update the display if required.
+*
+* Parameters:
+*  cy_eink_frame_t* frameBuffer   : Pointer to the frame buffer array in RAM
+*  char const* string             : Pointer to the string
+*  cy_eink_font_t const* fontInfo : Structure that stores font information
+*  uint16_t x                     : Left pixel of the text
+*  uint16_t y                     : Top pixel of the text
+*
+* Return:
+*  uint16_t : Pixel location to the right of the text, where a following text
+*             can be drawn
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+uint16_t Cy_EINK_DrawText(cy_eink_frame_t* frameBuffer, char const* string, 
+                          cy_eink_font_t const* fontInfo, uint16_t x, uint16_t y)
+{
+    /* Value XOR-ed to the font data: the font data is set for the characters,
+       while the frame buffer is set for white pixels */
+    uint32_t    invert = ((fontInfo->color) == CY_EINK_WHITE_BACKGROUND) ? 
+                         0xFFFFFFFFu : 0x00000000u;
+    
+    /* Size of the font data of one character */
+    uint16_t    glyphSize = (uint16_t)(fontInfo->xSize) * (fontInfo->ySize);
+    
+    /* Number of glyph rows that fit the display */
+    uint8_t     rowCount;
+    
+    /* Width of the current character, and its part drawn */
+    uint8_t     charWidth;
+    uint8_t     drawWidth;
+    
+    /* Pixel data of the current character, or NULL for a blank character */
+    uint8_t const* glyph;
+    
+    /* Frame bytes covered by the current character, its pixel shift within 
+       the first byte, and the mask of its pixels shifted the same way */
+    uint8_t*    frameByte;
+    uint8_t     byteCount;
+    uint8_t     shift;
+    uint32_t    mask;
+    
+    /* Current glyph row, shifted to its frame location */
+    uint32_t    rowBits;
+    
+    uint8_t     row;
+    uint8_t     i;
+    
+    if (y >= CY_EINK_HEIGHT)
+    {
+        return x;
+    }
+    rowCount = ((y + (fontInfo->ySize)) > CY_EINK_HEIGHT) ? 
+               (uint8_t)(CY_EINK_HEIGHT - y) : (fontInfo->ySize);
+    
+    for (; (*string != '\0') && (x < CY_EINK_WIDTH); string++)
+    {
+        charWidth = Cy_EINK_CharWidth(fontInfo, *string);
+        
+        /* Clip the character to the display and to the 32-bit word */
+        drawWidth = ((x + charWidth) > CY_EINK_WIDTH) ? 
+                    (uint8_t)(CY_EINK_WIDTH - x) : charWidth;
+        if (drawWidth > CY_EINK_TEXT_MAX_WIDTH)
+        {
+            drawWidth = CY_EINK_TEXT_MAX_WIDTH;
+        }
+        if (drawWidth == 0u)
+        {
+            x += charWidth;
+            continue;
+        }
+        
+        glyph = NULL;
+        if (((uint8_t)*string <= CY_EINK_ASCII_MAX) &&
+            ((uint8_t)*string >= CY_EINK_ASCII_MIN))
+        {
+            glyph = &fontInfo->fontData[((uint8_t)*string - CY_EINK_ASCII_MIN) *
+                                        glyphSize];
+        }
+        
+        /* The least significant bit of a frame byte is its leftmost pixel, so
+           the word holds the pixels from its least significant bit up */
+        shift     = (uint8_t)(x & 7u);
+        mask      = (0xFFFFFFFFu >> (32u - drawWidth)) << shift;
+        byteCount = (uint8_t)((shift + drawWidth + 7u) >> 3u);
+        frameByte = &frameBuffer[(y * PV_EINK_HORIZONTAL_SIZE) + (x >> 3u)];
+        
+        for (row = 0u; row < rowCount; row++)
+        {
+            /* Align the glyph row on the least significant bit of the word, 
+               then shift it to the pixel location */
+            rowBits = 0u;
+            if (glyph != NULL)
+            {
+                for (i = 0u; (i < (fontInfo->xSize)) && (i < 4u); i++)
+                {
+                    rowBits |= (uint32_t)glyph[i] << (i << 3u);
+                }
+                glyph += fontInfo->xSize;
+            }
+            rowBits = (rowBits << shift) ^ invert;
+            
+            /* Merge the word into the frame bytes under the mask */
+            for (i = 0u; i < byteCount; i++)
+            {
+                frameByte[i] = (uint8_t)((frameByte[i] & 
+                                          ~(mask >> (i << 3u))) |
+                                         ((rowBits & mask) >> (i << 3u)));
+            }
+            frameByte += PV_EINK_HORIZONTAL_SIZE;
+        }
+        
+        x += charWidth;
+    }
+    
+    return x;
+}
+
+/*******************************************************************************
+* Function Name: static void Cy_EINK_FillPixels(uint8_t* line, uint16_t x,
+*                                               uint16_t count, bool white)
+********************************************************************************
+*
+* Summary: Sets consecutive pixels of a frame buffer line to one color. Whole
+*  bytes are written at once.
+*
+* Parameters:
+*  uint8_t* line  : Pointer to the frame buffer line
+*  uint16_t x     : First pixel
+*  uint16_t count : Number of pixels
+*  bool white     : Color of the pixels
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static void Cy_EINK_FillPixels(uint8_t* line, uint16_t x, uint16_t count, 
+                               bool white)
+{
+    uint8_t*    frameByte = &line[x >> 3u];
+    uint8_t     fill = white ? CY_EINK_CLEAR_TO_WHITE : CY_EINK_CLEAR_TO_BLACK;
+    uint8_t     shift = (uint8_t)(x & 7u);
+    uint8_t     pixels;
+    uint8_t     mask;
+    
+    /* Pixels up to the first byte boundary */
+    if (shift != 0u)
+    {
+        pixels = (uint8_t)(8u - shift);
+        if (pixels > count)
+        {
+            pixels = (uint8_t)count;
+        }
+        mask = (uint8_t)(((1u << pixels) - 1u) << shift);
+        *frameByte = (uint8_t)((*frameByte & ~mask) | (fill & mask));
+        frameByte++;
+        count -= pixels;
+    }
+    
+    /* Whole bytes */
+    memset(frameByte, fill, count >> 3u);
+    frameByte += count >> 3u;
+    count &= 7u;
+    
+    /* Pixels after the last byte boundary */
+    if (count != 0u)
+    {
+        mask = (uint8_t)((1u << count) - 1u);
+        *frameByte = (uint8_t)((*frameByte & ~mask) | (fill & mask));
+    }
+}
+
+/*******************************************************************************
+* Function Name: static void Cy_EINK_PutPixels(uint8_t* line, uint16_t x,
+*                                              uint8_t bits, uint8_t count)
+********************************************************************************
+*
+* Summary: Copies up to 8 pixels into a frame buffer line.
+*
+* Parameters:
+*  uint8_t* line  : Pointer to the frame buffer line
+*  uint16_t x     : First pixel
+*  uint8_t bits   : Pixels, first pixel in the least significant bit
+*  uint8_t count  : Number of pixels, 1 to 8
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static void Cy_EINK_PutPixels(uint8_t* line, uint16_t x, uint8_t bits, 
+                              uint8_t count)
+{
+    uint8_t*    frameByte = &line[x >> 3u];
+    uint8_t     shift = (uint8_t)(x & 7u);
+    uint16_t    mask = (uint16_t)(((1u << count) - 1u) << shift);
+    uint16_t    value = (uint16_t)((uint16_t)bits << shift);
+    
+    frameByte[0] = (uint8_t)((frameByte[0] & ~mask) | (value & mask));
+    
+    /* Only touch the next byte if pixels fall into it */
+    if ((mask & 0xFF00u) != 0u)
+    {
+        frameByte[1] = (uint8_t)((frameByte[1] & ~(mask >> 8u)) | 
+                                 ((value & mask) >> 8u));
+    }
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_AssetToFrameBuffer(cy_eink_frame_t* frameBuffer,
+*                cy_eink_asset_t const* asset, uint16_t x, uint16_t y)
+********************************************************************************
+*
+* Summary: Decompresses an image asset into a frame buffer, with its top left
+*  pixel at any pixel location. The asset is clipped at the right and bottom
+*  edges of the display.
+*
+*  Notes: The asset data is decoded as a stream, without an intermediate 
+*  buffer. Runs are written a byte at a time and literals touch at most two 
+*  bytes, so the decoding time is proportional to the area of the asset. See 
+*  cy_eink_assets.h for the asset format.
+*
+*  This function does not update the E-INK display. After frame buffer update,
+*  use Cy_EINK_ShowFrame() or Cy_EINK_ShowRegion() to update the display if 
+*  required.
+*
+* Parameters:
+*  cy_eink_frame_t* frameBuffer   : Pointer to the frame buffer array in RAM
+*  cy_eink_asset_t const* asset   : Pointer to the asset (typically in flash)
+*  uint16_t x                     : Left pixel of the asset
+*  uint16_t y                     : Top pixel of the asset
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_AssetToFrameBuffer(cy_eink_frame_t* frameBuffer, 
+                                cy_eink_asset_t const* asset, uint16_t x, 
+                                uint16_t y)
+{
+    /* Next code of the asset data, and the end of the data */
+    uint8_t const* code = asset->data;
+    uint8_t const* dataEnd = &asset->data[asset->dataSize];
+    
+    /* Part of the asset that fits the display */
+    uint16_t    visibleWidth;
+    uint16_t    visibleHeight;
+    
+    /* Current location in the asset, and the current frame buffer line */
+    uint16_t    column = 0u;
+    uint16_t    row = 0u;
+    uint8_t*    line;
+    
+    /* Pixels of the current code left to write, and the pixels written in the
+       current row */
+    uint16_t    length;
+    uint16_t    pixels;
+    
+    /* Color of the current run, or pixels of the current literal */
+    bool        white = false;
+    uint8_t     bits = 0u;
+    bool        run;
+    
+    if ((x >= CY_EINK_WIDTH) || (y >= CY_EINK_HEIGHT) || 
+        (asset->width == 0u) || (asset->height == 0u))
+    {
+        return;
+    }
+    visibleWidth  = ((x + asset->width) > CY_EINK_WIDTH) ? 
+                    (uint16_t)(CY_EINK_WIDTH - x) : asset->width;
+    visibleHeight = ((y + asset->height) > CY_EINK_HEIGHT) ? 
+                    (uint16_t)(CY_EINK_HEIGHT - y) : asset->height;
+    line = &frameBuffer[y * PV_EINK_HORIZONTAL_SIZE];
+    
+    while ((code < dataEnd) && (row < visibleHeight))
+    {
+        run = ((*code & CY_EINK_ASSET_RUN) != 0u);
+        if (run)
+        {
+            white  = ((*code & CY_EINK_ASSET_RUN_WHITE) != 0u);
+            length = (uint16_t)(*code & CY_EINK_ASSET_RUN_LENGTH);
+            if ((*code & CY_EINK_ASSET_RUN_LONG) != 0u)
+            {
+                code++;
+                if (code >= dataEnd)
+                {
+                    break;
+                }
+                length = (uint16_t)((length << 8u) | *code);
+            }
+            length++;
+        }
+        else
+        {
+            /* The literal has the bit order of the frame buffer */
+            bits   = (uint8_t)(*code & (uint8_t)~CY_EINK_ASSET_RUN);
+            length = CY_EINK_ASSET_LITERAL_PIXELS;
+        }
+        code++;
+        
+        /* Write the pixels of the code row by row */
+        while ((length > 0u) && (row < visibleHeight))
+        {
+            pixels = asset->width - column;
+            if (pixels > length)
+            {
+                pixels = length;
+            }
+            
+            if (column < visibleWidth)
+            {
+                if (run)
+                {
+                    Cy_EINK_FillPixels(line, x + column, 
+                                       ((column + pixels) > visibleWidth) ?
+                                       (visibleWidth - column) : pixels, white);
+                }
+                else
+                {
+                    Cy_EINK_PutPixels(line, x + column, bits, 
+                                      (uint8_t)(((column + pixels) > visibleWidth) ?
+                                                (visibleWidth - column) : pixels));
+                }
+            }
+            
+            if (!run)
+            {
+                bits = (uint8_t)(bits >> pixels);
+            }
+            column += pixels;
+            length -= pixels;
+            if (column == asset->width)
+            {
+                column = 0u;
+                row++;
+                line += PV_EINK_HORIZONTAL_SIZE;
+            }
+        }
+    }
+}
+
 /* [] END OF FILE */
@@ -60,6 +60,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "cy_eink_fonts.h"
+#include "cy_eink_assets.h"
 
 /* Macros used for E-INK power control */
 #define CY_EINK_OFF                (false)
@@ -98,6 +99,15 @@
 #define CY_EINK_CLEAR_TO_WHITE     (uint8_t) (0xFF)
 #define CY_EINK_CLEAR_TO_BLACK     (uint8_t) (0x00)
 
+/* Frame buffer bit of a pixel. The frame buffer has the layout that emWin 
+   draws with Config.Mirror = 1 (see LCDConf.c): the leftmost pixel of a byte
+   is its least significant bit */
+#define CY_EINK_PIXEL_BIT(x)       (uint8_t) (0x01u << ((x) & 7u))
+
+/* Size of the E-INK display in pixels */
+#define CY_EINK_WIDTH              (uint16_t) (264u)
+#define CY_EINK_HEIGHT             (uint16_t) (176u)
+
 /* Size of an E-INK frame = size of an E-INK image = (264*176)/8 = 5808 bytes */
 #define CY_EINK_FRAME_SIZE         PV_EINK_IMAGE_SIZE
 #define CY_EINK_IMAGE_SIZE         PV_EINK_IMAGE_SIZE
@@ -113,24 +123,42 @@ typedef enum
     CY_EINK_FULL_2STAGE 
 }   cy_eink_update_t;
 
+/* Data type of a pixel rectangle. The limits are inclusive */
+typedef struct
+{
+    uint16_t x1;
+    uint16_t y1;
+    uint16_t x2;
+    uint16_t y2;
+}   cy_eink_rect_t;
+
 /* Declarations of functions provided by cy_eink_library.c. For the details of 
    E-INK library functions, see Appendix A of the CE218133 - PSoC 6 MCU E-INK 
    Display with CapSense code example document */
 
 /* Power and initialization functions */
-void Cy_EINK_Start(int8_t temperature);
+bool Cy_EINK_Start(int8_t temperature);
 bool Cy_EINK_Power(bool powerCtrl);
 
 /* Display update functions */
 void Cy_EINK_Clear(bool background, bool powerCycle);
 void Cy_EINK_ShowFrame(cy_eink_frame_t* prevFrame, cy_eink_frame_t* newFrame,
                        cy_eink_update_t updateType, bool powerCycle);
+void Cy_EINK_ShowRegion(cy_eink_frame_t* prevFrame, cy_eink_frame_t* newFrame,
+                        cy_eink_rect_t const* rect, cy_eink_update_t updateType,
+                        bool powerCycle);
 
 /* Frame buffer operations */
 void Cy_EINK_ImageToFrameBuffer(cy_eink_frame_t* frameBuffer, cy_eink_frame_t* image,
                                 uint8_t* imgCoordinates);
 void Cy_EINK_TextToFrameBuffer(cy_eink_frame_t* frameBuffer, char* string,
                             cy_eink_font_t* fontInfo, uint8_t* textCoordinates);
+uint16_t Cy_EINK_DrawText(cy_eink_frame_t* frameBuffer, char const* string, 
+                          cy_eink_font_t const* fontInfo, uint16_t x, uint16_t y);
+uint16_t Cy_EINK_TextWidth(char const* string, cy_eink_font_t const* fontInfo);
+void Cy_EINK_AssetToFrameBuffer(cy_eink_frame_t* frameBuffer, 
+                                cy_eink_asset_t const* asset, uint16_t x, 
+                                uint16_t y);
 
 #endif /* CY_EINK_LIBRARY_H */
 /* [] END OF FILE */
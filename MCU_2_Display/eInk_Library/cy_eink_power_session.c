@@ -0,0 +1,278 @@
+/******************************************************************************
+* File Name: cy_eink_power_session.c
+*
+* Version: 1.10
+*
+* Description: This file contains the power session manager of the E-INK 
+*              display.
+*
+* Hardware Dependency: CY8CKIT-028-EPD E-INK Display Shield
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* This file contains the power session manager of the E-INK display.
+*
+* Turning the display on and off takes several hundred milliseconds of power 
+* sequencing, driver initialization and discharge. The session keeps the display
+* powered between updates. A FreeRTOS software timer signals the display task
+* once the display has been idle for the configured timeout, and the display 
+* task turns it off in Cy_EINK_SessionProcessIdle(). The power off sequence 
+* blocks for several hundred milliseconds and does not run in the timer task.
+*******************************************************************************/
+
+/* Header file includes */
+#include <eInk_Library/cy_eink_power_session.h>
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "timers.h"
+
+/* Software timer that turns the display off after the idle timeout */
+TimerHandle_t static        idleTimer;
+
+/* Mutex that serializes the display updates and the power control */
+SemaphoreHandle_t static    sessionMutex;
+
+/* Semaphore of the display task that is given when the idle timeout expires */
+SemaphoreHandle_t static    idleSignal;
+
+/* True while the display is powered */
+bool static                 displayPowered;
+
+/* True when the idle timeout has expired and the display task has not yet
+   turned the display off */
+bool static volatile        idleExpired;
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_SessionIdleCallback(TimerHandle_t timer)
+********************************************************************************
+*
+* Summary: Signals the display task that the idle timeout has expired.
+*
+* Parameters:
+*  TimerHandle_t timer : Handle of the idle timer
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  Runs in the FreeRTOS timer task. Does not block.
+*
+*******************************************************************************/
+static void Cy_EINK_SessionIdleCallback(TimerHandle_t timer)
+{
+    (void) timer;
+    
+    /* The display is turned off by the display task; the timer task would 
+       otherwise stall every other software timer during the power off 
+       sequence */
+    idleExpired = true;
+    xSemaphoreGive(idleSignal);
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_SessionInit(uint32_t idleTimeout, 
+*                                         SemaphoreHandle_t signal)
+********************************************************************************
+*
+* Summary: Creates the idle timer and the mutex of the power session. 
+*
+*  Notes: Call this function once after Cy_EINK_Start(), with the display
+*  turned off. The display task must call Cy_EINK_SessionProcessIdle() each
+*  time it takes the semaphore passed in signal.
+*
+* Parameters:
+*  uint32_t idleTimeout     : Time in mS after the last update before the 
+*                             display is turned off
+*  SemaphoreHandle_t signal : Semaphore the display task waits on. It is given
+*                             when the idle timeout expires.
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_SessionInit(uint32_t idleTimeout, SemaphoreHandle_t signal)
+{
+    sessionMutex = xSemaphoreCreateMutex();
+    idleTimer = xTimerCreate("eink_idle", pdMS_TO_TICKS(idleTimeout), pdFALSE,
+                             NULL, Cy_EINK_SessionIdleCallback);
+    idleSignal = signal;
+    displayPowered = false;
+    idleExpired = false;
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_SessionProcessIdle(void)
+********************************************************************************
+*
+* Summary: Turns the display off if the idle timeout has expired since the 
+*  last call.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool : "True" if the idle timeout had expired and the semaphore was given
+*         for it; "False" if the semaphore was given for another event
+*
+* Side Effects:
+*  Turning the display off can take several hundred milliseconds.
+*
+*******************************************************************************/
+bool Cy_EINK_SessionProcessIdle(void)
+{
+    if (!idleExpired)
+    {
+        return(false);
+    }
+    
+    xSemaphoreTake(sessionMutex, portMAX_DELAY);
+    idleExpired = false;
+    
+    /* An update made after the timer expired restarts the timer and keeps
+       the display on */
+    if (displayPowered && (xTimerIsTimerActive(idleTimer) == pdFALSE))
+    {
+        Cy_EINK_Power(CY_EINK_OFF);
+        displayPowered = false;
+    }
+    
+    xSemaphoreGive(sessionMutex);
+    
+    return(true);
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_SessionAcquire(void)
+********************************************************************************
+*
+* Summary: Starts a display update. Turns the display on if it is off and keeps
+*  it on until Cy_EINK_SessionRelease() is called.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool : "True" if the display is powered; "False" otherwise
+*
+* Side Effects:
+*  Blocks while a power down is in progress. Turning the display on can take
+*  several hundred milliseconds.
+*
+*******************************************************************************/
+bool Cy_EINK_SessionAcquire(void)
+{
+    xSemaphoreTake(sessionMutex, portMAX_DELAY);
+    xTimerStop(idleTimer, portMAX_DELAY);
+    
+    if (!displayPowered)
+    {
+        displayPowered = Cy_EINK_Power(CY_EINK_ON);
+    }
+    
+    return(displayPowered);
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_SessionRelease(void)
+********************************************************************************
+*
+* Summary: Ends a display update and restarts the idle timeout.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_SessionRelease(void)
+{
+    if (displayPowered)
+    {
+        xTimerReset(idleTimer, portMAX_DELAY);
+    }
+    xSemaphoreGive(sessionMutex);
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_SessionPowerDown(void)
+********************************************************************************
+*
+* Summary: Turns the display off at once, without waiting for the idle timeout.
+*
+*  Notes: Call this function before entering a low power mode that does not 
+*  retain the state of the display driver.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool : "True" if the display is off; "False" otherwise
+*
+* Side Effects:
+*  Blocks until an update in progress has finished.
+*
+*******************************************************************************/
+bool Cy_EINK_SessionPowerDown(void)
+{
+    /* Operation status */
+    bool pwrStatus = CY_EINK_OPERATION_SUCCESS;
+    
+    /* The display has not been used if the session was never initialized */
+    if (sessionMutex == NULL)
+    {
+        return(pwrStatus);
+    }
+    
+    xSemaphoreTake(sessionMutex, portMAX_DELAY);
+    xTimerStop(idleTimer, portMAX_DELAY);
+    idleExpired = false;
+    
+    if (displayPowered)
+    {
+        pwrStatus = Cy_EINK_Power(CY_EINK_OFF);
+        displayPowered = false;
+    }
+    
+    xSemaphoreGive(sessionMutex);
+    
+    return(pwrStatus);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,69 @@
+/******************************************************************************
+* File Name: cy_eink_power_session.h
+*
+* Version: 1.10
+*
+* Description: This file contains function declarations and macro definitions 
+*              provided by the cy_eink_power_session.c file.
+*
+* Hardware Dependency: CY8CKIT-028-EPD E-INK Display Shield
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* The power session keeps the E-INK display powered while updates arrive in 
+* quick succession and turns it off once no update has been made for the idle
+* timeout. Wrap each display update in Cy_EINK_SessionAcquire() and 
+* Cy_EINK_SessionRelease() and call Cy_EINK_ShowFrame() without power cycle.
+* The display is turned off in the display task, by Cy_EINK_SessionProcessIdle().
+*******************************************************************************/
+/* Include Guard */
+#ifndef CY_EINK_POWER_SESSION_H
+#define CY_EINK_POWER_SESSION_H
+
+/* Header file includes */
+#include <eInk_Library/cy_eink_library.h>
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* Default time in mS after the last update before the display is turned off */
+#define CY_EINK_SESSION_IDLE_TIMEOUT    (uint32_t) (2000u)
+
+/* Declarations of functions provided by cy_eink_power_session.c */
+void Cy_EINK_SessionInit(uint32_t idleTimeout, SemaphoreHandle_t signal);
+bool Cy_EINK_SessionProcessIdle(void);
+bool Cy_EINK_SessionAcquire(void);
+void Cy_EINK_SessionRelease(void);
+bool Cy_EINK_SessionPowerDown(void);
+
+#endif /* CY_EINK_POWER_SESSION_H */
+/* [] END OF FILE */
@@ -58,8 +58,56 @@
 /* Define SPI interface to communicate with the EInk driver */
 cyhal_spi_t	SPI;
 
+/* Free-running timer used as the E-INK time base */
+static cyhal_timer_t    einkTimer;
+static bool             einkTimerStarted;
+
+/* Timer count at the start of the current measurement */
 static uint32_t timerCount;
 
+/* A single CS-framed SPI transaction of the asynchronous queue: the header
+   bytes are followed by an optional data buffer, both sent with CS held LOW */
+typedef struct
+{
+    uint8_t*    header;
+    uint8_t*    data;
+    uint16_t    dataLength;
+    uint8_t     headerLength;
+}   cy_eink_spi_transaction_t;
+
+/* Ring of pending asynchronous SPI transactions */
+static cy_eink_spi_transaction_t    spiQueue[CY_EINK_SPI_QUEUE_SIZE];
+static volatile uint8_t             spiQueueHead;
+static volatile uint8_t             spiQueueCount;
+
+/* Flag that indicates the data phase of the active transaction is pending */
+static volatile bool                spiDataPending;
+
+/* Flag that indicates the queue owns the SPI block. The transfer complete
+   event also fires for the blocking register transfers, which must not touch
+   the queue */
+static volatile bool                spiAsyncActive;
+
+/* Task that waits for the SPI queue to drain */
+static TaskHandle_t                 spiWaitingTask;
+
+/* Task that waits for the BUSY pin to go LOW */
+static TaskHandle_t                 busyWaitingTask;
+
+#ifdef CY_EINK_BENCHMARK
+/* SPI traffic counted for the benchmark */
+static volatile uint32_t            spiByteCount;
+static volatile uint32_t            spiTransactionCount;
+
+#define CY_EINK_COUNT_SPI_BYTES(count)  (spiByteCount += (count))
+#else
+#define CY_EINK_COUNT_SPI_BYTES(count)
+#endif /* CY_EINK_BENCHMARK */
+
+static void Cy_EINK_SPIEventCallback(void* callbackArg, cyhal_spi_event_t event);
+static void Cy_EINK_AbortSPIQueue(void);
+static void Cy_EINK_BusyEventCallback(void* callbackArg, cyhal_gpio_event_t event);
+
 /*******************************************************************************
 * Function Name: void CY_EINK_InitDriver(uint8_t value)
 ********************************************************************************
@@ -85,6 +133,110 @@ void CY_EINK_InitDriver(void)
 	cyhal_gpio_init(EINK_DISPEN, CYHAL_GPIO_DIR_OUTPUT, CYHAL_GPIO_DRIVE_STRONG, 0);
 	cyhal_gpio_init(EINK_BORDER, CYHAL_GPIO_DIR_OUTPUT, CYHAL_GPIO_DRIVE_STRONG, 0);
 	cyhal_gpio_init(EINK_DISPIOEN, CYHAL_GPIO_DIR_OUTPUT, CYHAL_GPIO_DRIVE_STRONG, 0);
+
+	/* The falling edge of the BUSY pin wakes the task that waits for it */
+	cyhal_gpio_register_callback(EINK_DISPBUSY, Cy_EINK_BusyEventCallback, NULL);
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_StartTimer(void)
+********************************************************************************
+*
+* Summary:
+*  Starts the free-running E-INK timer, if it is not running yet. The timer 
+*  counts up once per microsecond and must be a 32-bit TCPWM counter: a 16-bit
+*  counter would wrap around every 65 mS, within a single update stage.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool : "True" if the timer runs; "False" if no 32-bit counter could be 
+*         started
+*
+* Side Effects:
+*  Reserves a TCPWM counter and a clock divider for as long as the timer runs
+*******************************************************************************/
+bool Cy_EINK_StartTimer(void)
+{
+    const cyhal_timer_cfg_t timerConfig =
+    {
+        .is_continuous = true,
+        .direction = CYHAL_TIMER_DIR_UP,
+        .is_compare = false,
+        .period = UINT32_MAX,
+        .compare_value = 0u,
+        .value = 0u
+    };
+    cy_rslt_t result;
+
+    if (einkTimerStarted)
+    {
+        return(true);
+    }
+
+    result = cyhal_timer_init(&einkTimer, NC, NULL);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        return(false);
+    }
+
+    /* The HAL allocates the counters of TCPWM0, which are 32-bit, first; only
+       the 16-bit counters of TCPWM1 may be left when they are all in use */
+    if (CYHAL_TCPWM_DATA[einkTimer.resource.block_num].max_count != 32u)
+    {
+        result = CYHAL_TIMER_RSLT_ERR_BAD_ARGUMENT;
+    }
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = cyhal_timer_configure(&einkTimer, &timerConfig);
+    }
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = cyhal_timer_set_frequency(&einkTimer, CY_EINK_TIMER_FREQUENCY);
+    }
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = cyhal_timer_start(&einkTimer);
+    }
+    if (result != CY_RSLT_SUCCESS)
+    {
+        cyhal_timer_free(&einkTimer);
+        return(false);
+    }
+
+    einkTimerStarted = true;
+    return(true);
+}
+
+/*******************************************************************************
+* Function Name: static uint32_t Cy_EINK_ReadTimer(void)
+********************************************************************************
+*
+* Summary:
+*  Returns the count of the free-running E-INK timer. The timer counts up once
+*  per microsecond on a 32-bit TCPWM counter and wraps around after about 71 
+*  minutes, so only the differences of two counts are meaningful.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : current count of the timer, or 0 if Cy_EINK_StartTimer() has not
+*             succeeded
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static uint32_t Cy_EINK_ReadTimer(void)
+{
+    if (!einkTimerStarted)
+    {
+        return(0u);
+    }
+
+    return(Cy_TCPWM_Counter_GetCounter(einkTimer.base, 
+                                       einkTimer.resource.channel_num));
 }
 
 /*******************************************************************************
@@ -105,7 +257,7 @@ void CY_EINK_InitDriver(void)
 *******************************************************************************/
 void Cy_EINK_TimerInit(void)
 {   
-	timerCount = xTaskGetTickCount();
+	timerCount = Cy_EINK_ReadTimer();
 }
 
 /*******************************************************************************
@@ -119,7 +271,8 @@ void Cy_EINK_TimerInit(void)
 *  None
 *
 * Return:
-*  uint32_t : current value of time tick
+*  uint32_t : current value of time tick, in microseconds since 
+*             Cy_EINK_TimerInit() (see CY_EINK_TICKS_PER_MS)
 *
 * Side Effects:
 *  None
@@ -127,7 +280,7 @@ void Cy_EINK_TimerInit(void)
 uint32_t Cy_EINK_GetTimeTick(void)
 {
     /* Return the current value of time tick */
-	return(xTaskGetTickCount()-timerCount);
+	return(Cy_EINK_ReadTimer() - timerCount);
 }
 
 /*******************************************************************************
@@ -135,7 +288,8 @@ uint32_t Cy_EINK_GetTimeTick(void)
 ********************************************************************************
 *
 * Summary:
-*  Stops the E-INK Timer.
+*  Stops the E-INK Timer. The hardware timer keeps running as the time base of
+*  Cy_EINK_DelayUs().
 *
 * Parameters:
 *  None
@@ -151,6 +305,33 @@ void Cy_EINK_TimerStop(void)
 
 }
 
+/*******************************************************************************
+* Function Name: void Cy_EINK_DelayUs(uint32_t delay)
+********************************************************************************
+*
+* Summary:
+*  Waits for the given number of microseconds on the E-INK timer. Use 
+*  CY_EINK_Delay for delays of a millisecond or more, so that the calling task
+*  sleeps instead.
+*
+* Parameters:
+*  uint32_t delay : delay in microseconds
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  Busy-waits for the whole delay
+*******************************************************************************/
+void Cy_EINK_DelayUs(uint32_t delay)
+{
+    uint32_t startCount = Cy_EINK_ReadTimer();
+
+    while ((Cy_EINK_ReadTimer() - startCount) < delay)
+    {
+    }
+}
+
 /*******************************************************************************
 * Function Name: void Cy_EINK_InitSPI(void)
 ********************************************************************************
@@ -173,6 +354,14 @@ void Cy_EINK_InitSPI(void)
 	cyhal_spi_init(&SPI, EINK_MOSI, EINK_MISO, EINK_SCLK, NC, NULL, 8, CYHAL_SPI_MODE_00_MSB, false);
 	cyhal_spi_set_frequency(&SPI, 20000000);
 
+    /* Chain the queued transactions from the transfer complete interrupt */
+    spiQueueHead = 0;
+    spiQueueCount = 0;
+    spiAsyncActive = false;
+    cyhal_spi_register_callback(&SPI, Cy_EINK_SPIEventCallback, NULL);
+    cyhal_spi_enable_event(&SPI, CYHAL_SPI_IRQ_DONE, CY_EINK_SPI_INTR_PRIORITY,
+                           true);
+
     /* Make the chip select HIGH */
     CY_EINK_CsHigh;
 }
@@ -240,6 +429,7 @@ void Cy_EINK_WriteSPI(uint8_t data)
 {
     /* Send one byte of data */
     cyhal_spi_send(&SPI, data);
+    CY_EINK_COUNT_SPI_BYTES(1u);
 }
 
 /*******************************************************************************
@@ -285,6 +475,7 @@ uint8_t Cy_EINK_WriteReadSPI(uint8_t data)
 {
 	uint32_t readData;
 	cyhal_spi_send(&SPI, data);
+	CY_EINK_COUNT_SPI_BYTES(1u);
 	cyhal_spi_recv(&SPI, &readData);
 	return (uint8_t)readData;
 }
@@ -309,9 +500,232 @@ uint8_t Cy_EINK_WriteReadSPI(uint8_t data)
 int Cy_EINK_WriteSPIBuffer(uint8_t* data, uint16 dataLength)
 {
     cyhal_spi_transfer(&SPI, (const uint8_t*)data, dataLength, NULL, 0, 0);
+    CY_EINK_COUNT_SPI_BYTES(dataLength);
     return dataLength;
 }
 
+/*******************************************************************************
+* Function Name: static void Cy_EINK_StartSPITransaction(void)
+********************************************************************************
+*
+* Summary:
+*  Pulls the chip select LOW and starts the header phase of the transaction at
+*  the head of the queue. Must be called with the SPI interrupt masked or from
+*  the SPI interrupt itself.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static void Cy_EINK_StartSPITransaction(void)
+{
+    cy_eink_spi_transaction_t* transaction = &spiQueue[spiQueueHead];
+
+    spiDataPending = (transaction->dataLength != 0u);
+    spiAsyncActive = true;
+
+    CY_EINK_CsLow;
+    cyhal_spi_transfer_async(&SPI, (const uint8_t*)transaction->header,
+                             transaction->headerLength, NULL, 0);
+}
+
+/*******************************************************************************
+* Function Name: static void Cy_EINK_SPIEventCallback(void* callbackArg,
+*                                                     cyhal_spi_event_t event)
+********************************************************************************
+*
+* Summary:
+*  SPI transfer complete callback. Sends the data phase of the active
+*  transaction, or closes it and immediately starts the next queued one so that
+*  there are no idle gaps between the transactions. The waiting task is
+*  notified every time a transaction leaves the queue. Events of the blocking
+*  register transfers are ignored.
+*
+* Parameters:
+*  void* callbackArg       : Not used
+*  cyhal_spi_event_t event : SPI event that triggered the callback
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  Runs in the interrupt context
+*******************************************************************************/
+static void Cy_EINK_SPIEventCallback(void* callbackArg, cyhal_spi_event_t event)
+{
+    BaseType_t  higherPriorityTaskWoken = pdFALSE;
+    cy_eink_spi_transaction_t* transaction = &spiQueue[spiQueueHead];
+
+    (void)callbackArg;
+    (void)event;
+
+    /* Not a queued transfer */
+    if (!spiAsyncActive)
+    {
+        return;
+    }
+
+    /* Header is out, send the data with the chip select still LOW */
+    if (spiDataPending)
+    {
+        spiDataPending = false;
+        cyhal_spi_transfer_async(&SPI, (const uint8_t*)transaction->data,
+                                 transaction->dataLength, NULL, 0);
+        return;
+    }
+
+    /* Push the chip select line HIGH to end the transaction */
+    CY_EINK_CsHigh;
+
+    spiQueueHead = (spiQueueHead + 1u) % CY_EINK_SPI_QUEUE_SIZE;
+    spiQueueCount--;
+
+    /* Start the next transaction right away, or give the SPI back to the
+       blocking transfers */
+    if (spiQueueCount != 0u)
+    {
+        Cy_EINK_StartSPITransaction();
+    }
+    else
+    {
+        spiAsyncActive = false;
+    }
+
+    if (spiWaitingTask != NULL)
+    {
+        vTaskNotifyGiveFromISR(spiWaitingTask, &higherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+/*******************************************************************************
+* Function Name: static void Cy_EINK_AbortSPIQueue(void)
+********************************************************************************
+*
+* Summary:
+*  Stops the asynchronous transfer in progress and empties the SPI queue.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  The discarded transactions are not sent
+*******************************************************************************/
+static void Cy_EINK_AbortSPIQueue(void)
+{
+    taskENTER_CRITICAL();
+
+    (void)cyhal_spi_abort_async(&SPI);
+    CY_EINK_CsHigh;
+
+    spiQueueHead = 0u;
+    spiQueueCount = 0u;
+    spiDataPending = false;
+    spiAsyncActive = false;
+
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_QueueSPIBuffer(uint8_t* header,
+*             uint8_t headerLength, uint8_t* data, uint16_t dataLength)
+********************************************************************************
+*
+* Summary:
+*  Queues a CS-framed SPI transaction for asynchronous transmission. The header
+*  and data buffers are not copied and must stay valid until the transaction
+*  has been sent (see Cy_EINK_WaitSPIQueue).
+*
+* Parameters:
+*  uint8_t* header       : pointer to the header bytes
+*  uint8_t headerLength  : number of header bytes
+*  uint8_t* data         : pointer to the data bytes, can be NULL
+*  uint16_t dataLength   : number of data bytes, can be zero
+*
+* Return:
+*  bool : True if the transaction was queued, False if the queue stayed full
+*         and was aborted (see Cy_EINK_WaitSPIQueue)
+*
+* Side Effects:
+*  Blocks the calling task while the queue is full
+*******************************************************************************/
+bool Cy_EINK_QueueSPIBuffer(uint8_t* header, uint8_t headerLength,
+                            uint8_t* data, uint16_t dataLength)
+{
+    cy_eink_spi_transaction_t* transaction;
+
+    /* Wait for a free slot in the queue */
+    if (!Cy_EINK_WaitSPIQueue(CY_EINK_SPI_QUEUE_SIZE - 1u))
+    {
+        return(false);
+    }
+
+    taskENTER_CRITICAL();
+
+    transaction = &spiQueue[(spiQueueHead + spiQueueCount) %
+                            CY_EINK_SPI_QUEUE_SIZE];
+    transaction->header = header;
+    transaction->headerLength = headerLength;
+    transaction->data = data;
+    transaction->dataLength = dataLength;
+    spiQueueCount++;
+    CY_EINK_COUNT_SPI_BYTES(headerLength + dataLength);
+
+    /* Kick off the transfer if the SPI was idle */
+    if (spiQueueCount == 1u)
+    {
+        Cy_EINK_StartSPITransaction();
+    }
+
+    taskEXIT_CRITICAL();
+
+    return(true);
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_WaitSPIQueue(uint8_t maxPending)
+********************************************************************************
+*
+* Summary:
+*  Blocks the calling task until no more than maxPending transactions are left
+*  in the asynchronous SPI queue. The task sleeps on a task notification while
+*  it waits.
+*
+* Parameters:
+*  uint8_t maxPending : number of transactions that may still be pending.
+*                       Use 0 to wait until the queue is empty.
+*
+* Return:
+*  bool : True if the queue drained, False if it made no progress within
+*         CY_EINK_SPI_TIMEOUT
+*
+* Side Effects:
+*  On timeout the active transfer is aborted and the pending transactions are
+*  discarded, so that the SPI is left idle with the chip select HIGH
+*******************************************************************************/
+bool Cy_EINK_WaitSPIQueue(uint8_t maxPending)
+{
+    spiWaitingTask = xTaskGetCurrentTaskHandle();
+
+    while (spiQueueCount > maxPending)
+    {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CY_EINK_SPI_TIMEOUT)) == 0u)
+        {
+            Cy_EINK_AbortSPIQueue();
+            return(false);
+        }
+    }
+    return(true);
+}
+
 /*******************************************************************************
 * Function Name: bool CY_EINK_IsBusy(void)
 ********************************************************************************
@@ -334,4 +748,183 @@ bool Cy_EINK_IsBusy(void)
     return cyhal_gpio_read(EINK_DISPBUSY);
 }
 
+/*******************************************************************************
+* Function Name: static void Cy_EINK_BusyEventCallback(void* callbackArg,
+*                                                     cyhal_gpio_event_t event)
+********************************************************************************
+*
+* Summary:
+*  Interrupt callback of the BUSY pin. Wakes the task waiting for the E-INK
+*  driver to become ready.
+*
+* Parameters:
+*  void* callbackArg          : not used
+*  cyhal_gpio_event_t event   : GPIO event, only the falling edge is enabled
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static void Cy_EINK_BusyEventCallback(void* callbackArg, cyhal_gpio_event_t event)
+{
+    BaseType_t  higherPriorityTaskWoken = pdFALSE;
+
+    (void)callbackArg;
+    (void)event;
+
+    if (busyWaitingTask != NULL)
+    {
+        vTaskNotifyGiveFromISR(busyWaitingTask, &higherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_WaitWhileBusy(uint32_t timeout)
+********************************************************************************
+*
+* Summary:
+*  Blocks the calling task while the E-INK display is busy. The task sleeps on
+*  a task notification given by the falling edge of the BUSY pin.
+*
+* Parameters:
+*  uint32_t timeout : Maximum time to wait in mS
+*
+* Return:
+*  bool : True if the E-INK display is ready, False if it is still busy
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+bool Cy_EINK_WaitWhileBusy(uint32_t timeout)
+{
+    TickType_t  startTick = xTaskGetTickCount();
+    TickType_t  waitTicks = pdMS_TO_TICKS(timeout);
+    TickType_t  elapsedTicks;
+
+    busyWaitingTask = xTaskGetCurrentTaskHandle();
+    cyhal_gpio_enable_event(EINK_DISPBUSY, CYHAL_GPIO_IRQ_FALL,
+                            CY_EINK_BUSY_INTR_PRIORITY, true);
+
+    /* The notification is shared with the SPI queue, so check the pin again
+       after each wake-up */
+    while (Cy_EINK_IsBusy())
+    {
+        elapsedTicks = xTaskGetTickCount() - startTick;
+        if (elapsedTicks >= waitTicks)
+        {
+            break;
+        }
+        ulTaskNotifyTake(pdTRUE, waitTicks - elapsedTicks);
+    }
+
+    cyhal_gpio_enable_event(EINK_DISPBUSY, CYHAL_GPIO_IRQ_FALL,
+                            CY_EINK_BUSY_INTR_PRIORITY, false);
+    busyWaitingTask = NULL;
+
+    return (!Cy_EINK_IsBusy());
+}
+
+#ifdef CY_EINK_BENCHMARK
+/*******************************************************************************
+* Function Name: uint32_t Cy_EINK_GetCycleCount(void)
+********************************************************************************
+*
+* Summary:
+*  Returns the CPU cycle counter of the DWT unit, enabling it on the first call.
+*  The counter wraps around; use the difference of two readings.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : CPU cycles
+*
+* Side Effects:
+*  Enables the trace unit of the core.
+*******************************************************************************/
+uint32_t Cy_EINK_GetCycleCount(void)
+{
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0u)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0u;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    return(DWT->CYCCNT);
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_CountedCsLow(void)
+********************************************************************************
+*
+* Summary:
+*  Pulls the chip select pin to logic LOW and counts the SPI transaction. Used
+*  for CY_EINK_CsLow in the benchmark build.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+void Cy_EINK_CountedCsLow(void)
+{
+    spiTransactionCount++;
+    cyhal_gpio_write(EINK_DISPCS, CY_EINK_PIN_LOW);
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_ResetSPICounters(void)
+********************************************************************************
+*
+* Summary:
+*  Clears the SPI byte and transaction counters.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+void Cy_EINK_ResetSPICounters(void)
+{
+    spiByteCount = 0u;
+    spiTransactionCount = 0u;
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_GetSPICounters(uint32_t* bytes, 
+*                                            uint32_t* transactions)
+********************************************************************************
+*
+* Summary:
+*  Reads the number of bytes and CS-framed transactions sent to the E-INK 
+*  display driver since the last Cy_EINK_ResetSPICounters().
+*
+* Parameters:
+*  uint32_t* bytes        : Number of bytes sent
+*  uint32_t* transactions : Number of transactions
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+void Cy_EINK_GetSPICounters(uint32_t* bytes, uint32_t* transactions)
+{
+    *bytes = spiByteCount;
+    *transactions = spiTransactionCount;
+}
+#endif /* CY_EINK_BENCHMARK */
+
 /* [] END OF FILE */
@@ -77,6 +77,22 @@
 #define CY_EINK_BYTE_SIZE      (uint8_t)(0x08u)
 #define CY_EINK_SINGLE_BYTE    (uint8_t)(0x01u)
 
+/* Depth of the asynchronous SPI transaction queue. Each E-INK data line takes
+   four CS-framed transactions (pixel data index, pixel data, OE index, OE data) */
+#define CY_EINK_SPI_QUEUE_SIZE     (uint8_t)(16u)
+
+/* Interrupt priority of the SPI block used for the asynchronous transfers.
+   This must be numerically higher than configMAX_SYSCALL_INTERRUPT_PRIORITY
+   because the completion callback uses the FreeRTOS FromISR API */
+#define CY_EINK_SPI_INTR_PRIORITY  (uint8_t)(6u)
+
+/* Maximum time in mS to wait for the SPI queue to drain */
+#define CY_EINK_SPI_TIMEOUT        (uint16_t)(100u)
+
+/* Interrupt priority of the BUSY pin falling edge. The same FreeRTOS FromISR
+   constraint as for the SPI interrupt applies */
+#define CY_EINK_BUSY_INTR_PRIORITY (uint8_t)(6u)
+
 /* Definitions of pin sates */
 #define CY_EINK_PIN_LOW        (uint8_t)(0x00u)
 #define CY_EINK_PIN_HIGH       (uint8_t)(0x01u)
@@ -84,8 +100,13 @@
 /* Push the chip select pin to logic HIGH */
 #define CY_EINK_CsHigh         cyhal_gpio_write(EINK_DISPCS, CY_EINK_PIN_HIGH)
 
-/* Pull the chip select pin to logic LOW */
+/* Pull the chip select pin to logic LOW. The benchmark build also counts the 
+   transaction */
+#ifdef CY_EINK_BENCHMARK
+#define CY_EINK_CsLow          Cy_EINK_CountedCsLow()
+#else
 #define CY_EINK_CsLow          cyhal_gpio_write(EINK_DISPCS, CY_EINK_PIN_LOW)
+#endif
 
 /* Push the reset pin to logic HIGH */
 #define CY_EINK_RstHigh        cyhal_gpio_write(EINK_DISPRST, CY_EINK_PIN_HIGH)
@@ -120,13 +141,19 @@
 /* Firmware delay in mS */
 #define CY_EINK_Delay          vTaskDelay
 
-/* Firmware delay of 10uS (Reserved for future use) */
-#define CY_EINK_Wait10uS
+/* Firmware delay of 10uS */
+#define CY_EINK_Wait10uS       Cy_EINK_DelayUs(10u)
+
+/* Frequency of the E-INK timer. One tick of the timer is one microsecond */
+#define CY_EINK_TIMER_FREQUENCY    (uint32_t)(1000000u)
+#define CY_EINK_TICKS_PER_MS       (uint32_t)(CY_EINK_TIMER_FREQUENCY / 1000u)
 
 /* Functions used for E-INK display timing */
+bool        Cy_EINK_StartTimer(void);
 void        Cy_EINK_TimerInit(void);
 void        Cy_EINK_TimerStop(void);
 uint32_t    Cy_EINK_GetTimeTick(void);
+void        Cy_EINK_DelayUs(uint32_t delay);
 
 /* Functions used for E-INK driver communication */
 void 		CY_EINK_InitDriver(void);
@@ -137,6 +164,20 @@ void        Cy_EINK_WriteSPI(uint8_t data);
 uint8_t     Cy_EINK_ReadSPI(void);
 uint8_t     Cy_EINK_WriteReadSPI(uint8_t data);
 bool        Cy_EINK_IsBusy(void);
+bool        Cy_EINK_WaitWhileBusy(uint32_t timeout);
+
+/* Functions used for asynchronous E-INK driver communication */
+bool        Cy_EINK_QueueSPIBuffer(uint8_t* header, uint8_t headerLength,
+                                   uint8_t* data, uint16_t dataLength);
+bool        Cy_EINK_WaitSPIQueue(uint8_t maxPending);
+
+#ifdef CY_EINK_BENCHMARK
+/* Functions used by the E-INK benchmark */
+uint32_t    Cy_EINK_GetCycleCount(void);
+void        Cy_EINK_CountedCsLow(void);
+void        Cy_EINK_ResetSPICounters(void);
+void        Cy_EINK_GetSPICounters(uint32_t* bytes, uint32_t* transactions);
+#endif /* CY_EINK_BENCHMARK */
 
 #endif /* CY_EINK_INTERFACE_H */  
 /* [] END OF FILE */
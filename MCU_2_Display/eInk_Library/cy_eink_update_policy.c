@@ -0,0 +1,262 @@
+/******************************************************************************
+* File Name: cy_eink_update_policy.c
+*
+* Version: 1.10
+*
+* Description: This file contains the update policy that selects the update
+*              type of each E-INK frame.
+*
+* Hardware Dependency: CY8CKIT-028-EPD E-INK Display Shield
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* This file contains the update policy that selects the update type of each 
+* E-INK frame.
+*
+* A partial update only drives the changed pixels and is the fastest, but each
+* one leaves some ghosting that builds up. A 2-stage full update drives the 
+* inverted previous frame and then the new frame; a 4-stage full update adds an
+* all-white and an inverted new frame in between and gives the cleanest result.
+* Low temperatures make the panel slower and the ghosting stronger.
+*******************************************************************************/
+
+/* Header file includes */
+#include <eInk_Library/cy_eink_update_policy.h>
+
+/* Number of pixels of the display */
+#define CY_EINK_POLICY_PIXEL_COUNT   (uint32_t) (CY_EINK_FRAME_SIZE * 8u)
+
+/* Number of set bits of a 4-bit value */
+uint8_t const static    policyBitCount[16] = {0u, 1u, 1u, 2u, 1u, 2u, 2u, 3u,
+                                              1u, 2u, 2u, 3u, 2u, 3u, 3u, 4u};
+
+/* Thresholds in use */
+cy_eink_policy_config_t static policyConfig =
+{
+    CY_EINK_POLICY_PARTIAL_MAX_CHANGE,
+    CY_EINK_POLICY_2STAGE_MAX_CHANGE,
+    CY_EINK_POLICY_MAX_CONSECUTIVE_PARTIAL,
+    CY_EINK_POLICY_PARTIAL_MIN_TEMP,
+    CY_EINK_POLICY_2STAGE_MIN_TEMP
+};
+
+/* Panel temperature in degree Celsius */
+int8_t static           policyTemperature = CY_EINK_POLICY_2STAGE_MIN_TEMP;
+
+/* Number of partial updates since the last full update */
+uint8_t static          consecutivePartial;
+
+/* True until the first full update, as the display content is unknown */
+bool static             fullUpdatePending = true;
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_PolicyInit(cy_eink_policy_config_t const* config)
+********************************************************************************
+*
+* Summary: Sets the thresholds of the update policy and restarts its history,
+*  so that the next frame is shown with a 4-stage full update.
+*
+* Parameters:
+*  cy_eink_policy_config_t const* config : Thresholds to use, or NULL for the 
+*                                          default thresholds
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_PolicyInit(cy_eink_policy_config_t const* config)
+{
+    if (config != NULL)
+    {
+        policyConfig = *config;
+    }
+    consecutivePartial = 0u;
+    fullUpdatePending = true;
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_PolicySetTemperature(int8_t temperature)
+********************************************************************************
+*
+* Summary: Sets the panel temperature used by the update policy.
+*
+* Parameters:
+*  int8_t temperature : Panel temperature in degree Celsius
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_PolicySetTemperature(int8_t temperature)
+{
+    policyTemperature = temperature;
+}
+
+/*******************************************************************************
+* Function Name: uint16_t Cy_EINK_PolicyChangedPixels(cy_eink_frame_t* prevFrame,
+*                                                    cy_eink_frame_t* newFrame)
+********************************************************************************
+*
+* Summary: Returns the share of pixels that differ between two frames.
+*
+* Parameters:
+*  cy_eink_frame_t* prevFrame    : Pointer to the previous frame written on the display
+*  cy_eink_frame_t* newFrame     : Pointer to the new frame that need to be written
+*
+* Return:
+*  uint16_t : Changed pixels in per-mille of the display pixels
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+uint16_t Cy_EINK_PolicyChangedPixels(cy_eink_frame_t* prevFrame,
+                                     cy_eink_frame_t* newFrame)
+{
+    /* Counter variable for the frame bytes */
+    uint16_t byteCounter;
+    
+    /* Changed bits of the current byte */
+    uint8_t  changedBits;
+    
+    /* Number of changed pixels */
+    uint32_t changedPixels = 0u;
+    
+    for (byteCounter = 0u; byteCounter < CY_EINK_FRAME_SIZE; byteCounter++)
+    {
+        changedBits = prevFrame[byteCounter] ^ newFrame[byteCounter];
+        changedPixels += policyBitCount[changedBits & 0x0Fu] + 
+                         policyBitCount[changedBits >> 4u];
+    }
+    
+    /* Round up, so that any change counts */
+    return((uint16_t)(((changedPixels * 1000u) + CY_EINK_POLICY_PIXEL_COUNT - 1u) /
+                      CY_EINK_POLICY_PIXEL_COUNT));
+}
+
+/*******************************************************************************
+* Function Name: cy_eink_update_t Cy_EINK_PolicySelect(cy_eink_frame_t* prevFrame,
+*                                                     cy_eink_frame_t* newFrame)
+********************************************************************************
+*
+* Summary: Selects the update type for showing a new frame.
+*
+*  Notes: The selection does not change the history of the policy. Call 
+*  Cy_EINK_PolicyRecord() once the display has actually been updated.
+*
+* Parameters:
+*  cy_eink_frame_t* prevFrame    : Pointer to the previous frame written on the display
+*  cy_eink_frame_t* newFrame     : Pointer to the new frame that need to be written
+*
+* Return:
+*  cy_eink_update_t : Update type to use with Cy_EINK_ShowFrame()
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+cy_eink_update_t Cy_EINK_PolicySelect(cy_eink_frame_t* prevFrame,
+                                      cy_eink_frame_t* newFrame)
+{
+    /* Share of changed pixels in per-mille */
+    uint16_t changedPixels;
+    
+    /* The display content is unknown until the first full update */
+    if (fullUpdatePending)
+    {
+        return(CY_EINK_FULL_4STAGE);
+    }
+    
+    changedPixels = Cy_EINK_PolicyChangedPixels(prevFrame, newFrame);
+    
+    /* Small changes at a normal temperature, while the ghosting is bounded */
+    if ((changedPixels <= policyConfig.partialMaxChange) &&
+        (policyTemperature >= policyConfig.partialMinTemperature))
+    {
+        /* Clean up the ghosting of the previous partial updates */
+        if (consecutivePartial >= policyConfig.maxConsecutivePartial)
+        {
+            return(CY_EINK_FULL_4STAGE);
+        }
+        return(CY_EINK_PARTIAL);
+    }
+    
+    /* Larger changes at a normal temperature */
+    if ((changedPixels <= policyConfig.twoStageMaxChange) &&
+        (policyTemperature >= policyConfig.twoStageMinTemperature))
+    {
+        return(CY_EINK_FULL_2STAGE);
+    }
+    
+    return(CY_EINK_FULL_4STAGE);
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_PolicyRecord(cy_eink_update_t updateType)
+********************************************************************************
+*
+* Summary: Records an update of the display in the history of the policy.
+*
+* Parameters:
+*  cy_eink_update_t updateType : Update type that was used
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_PolicyRecord(cy_eink_update_t updateType)
+{
+    if (updateType == CY_EINK_PARTIAL)
+    {
+        if (consecutivePartial < UINT8_MAX)
+        {
+            consecutivePartial++;
+        }
+    }
+    else
+    {
+        consecutivePartial = 0u;
+        fullUpdatePending = false;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,91 @@
+/******************************************************************************
+* File Name: cy_eink_update_policy.h
+*
+* Version: 1.10
+*
+* Description: This file contains function declarations and macro definitions 
+*              provided by the cy_eink_update_policy.c file.
+*
+* Hardware Dependency: CY8CKIT-028-EPD E-INK Display Shield
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* The update policy selects the update type of each frame: a partial update for
+* small changes, a 2-stage full update for larger ones and a 4-stage full update
+* when the ghosting of successive partial updates or a low panel temperature 
+* calls for it. The thresholds can be changed with Cy_EINK_PolicyInit().
+*******************************************************************************/
+/* Include Guard */
+#ifndef CY_EINK_UPDATE_POLICY_H
+#define CY_EINK_UPDATE_POLICY_H
+
+/* Header file includes */
+#include <eInk_Library/cy_eink_library.h>
+
+/* Default thresholds of the update policy. Changed pixels are given in 
+   per-mille of the display pixels and temperatures in degree Celsius */
+#define CY_EINK_POLICY_PARTIAL_MAX_CHANGE       (uint16_t) (150u)
+#define CY_EINK_POLICY_2STAGE_MAX_CHANGE        (uint16_t) (400u)
+#define CY_EINK_POLICY_MAX_CONSECUTIVE_PARTIAL  (uint8_t)  (8u)
+#define CY_EINK_POLICY_PARTIAL_MIN_TEMP         (int8_t)   (5)
+#define CY_EINK_POLICY_2STAGE_MIN_TEMP          (int8_t)   (10)
+
+/* Thresholds of the update policy */
+typedef struct
+{
+    /* Largest share of changed pixels, in per-mille, for a partial update */
+    uint16_t partialMaxChange;
+    
+    /* Largest share of changed pixels, in per-mille, for a 2-stage update */
+    uint16_t twoStageMaxChange;
+    
+    /* Number of partial updates allowed before a 4-stage full update */
+    uint8_t  maxConsecutivePartial;
+    
+    /* Lowest panel temperatures, in degree Celsius, for a partial and for a 
+       2-stage update */
+    int8_t   partialMinTemperature;
+    int8_t   twoStageMinTemperature;
+}   cy_eink_policy_config_t;
+
+/* Declarations of functions provided by cy_eink_update_policy.c */
+void             Cy_EINK_PolicyInit(cy_eink_policy_config_t const* config);
+void             Cy_EINK_PolicySetTemperature(int8_t temperature);
+uint16_t         Cy_EINK_PolicyChangedPixels(cy_eink_frame_t* prevFrame,
+                                             cy_eink_frame_t* newFrame);
+cy_eink_update_t Cy_EINK_PolicySelect(cy_eink_frame_t* prevFrame,
+                                      cy_eink_frame_t* newFrame);
+void             Cy_EINK_PolicyRecord(cy_eink_update_t updateType);
+
+#endif /* CY_EINK_UPDATE_POLICY_H */
+/* [] END OF FILE */
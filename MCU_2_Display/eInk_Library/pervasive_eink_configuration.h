@@ -155,6 +155,10 @@
 #define PV_EINK_DISCH_SPI_DELAY             (uint16_t)(50)
 #define PV_EINK_PWR_OFF_DELAY               (uint16_t)(30)
 
+/* First interval of the DC level polling. The interval doubles after each 
+   check, up to a total of PV_EINK_PWR_CTRL_DELAY */
+#define PV_EINK_DC_LEVEL_POLL_DELAY         (uint16_t)(2)
+
 /* Definitions of pixel data generating parameters */
 #define PV_EINK_PIXEL_SIZE                  (uint8_t)(0x02u)
 #define PV_EINK_CHANNEL_SEL_SIZE            (uint8_t)(0x08u)
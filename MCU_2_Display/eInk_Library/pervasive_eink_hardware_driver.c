@@ -48,6 +48,60 @@
 /* Data used to initialize the scan bytes */
 #define PV_EINK_SCAN_BYTE_INIT (uint8_t)(0x00u)
 
+/* Number of SPI transactions that send and latch a data line */
+#define PV_EINK_LINE_TRANSACTIONS (uint8_t)(0x04u)
+
+/* Number of line buffers in the line ring. The SPI queue must be able to hold
+   all of them */
+#define PV_EINK_LINE_RING_SIZE (uint8_t)(CY_EINK_SPI_QUEUE_SIZE / \
+                                         PV_EINK_LINE_TRANSACTIONS)
+
+/* Size of the bitmap that flags the changed lines of a partial update */
+#define PV_EINK_ROW_BITMAP_SIZE (uint8_t)((PV_EINK_VERTICAL_SIZE + 7u) >> 3u)
+
+/* Number of full update stages and entries of an encoding lookup table */
+#define PV_EINK_STAGE_COUNT    (uint8_t)(0x04u)
+#define PV_EINK_LUT_SIZE       (uint16_t)(256u)
+
+/* Odd and Even data bytes of an image data byte. Each image bit selects the
+   "set" or "clear" pixel code, given as the code of pixel 0 */
+#define PV_EINK_PIXEL_CODE(data, mask, set, clear)  \
+                                (((data) & (mask)) ? (set) : (clear))
+#define PV_EINK_ODD_BYTE(data, set, clear)  (uint8_t)(                        \
+    (PV_EINK_PIXEL_CODE(data, PV_EINK_ODD_MASK_A, set, clear) << 6) |         \
+    (PV_EINK_PIXEL_CODE(data, PV_EINK_ODD_MASK_B, set, clear) << 4) |         \
+    (PV_EINK_PIXEL_CODE(data, PV_EINK_ODD_MASK_C, set, clear) << 2) |         \
+    (PV_EINK_PIXEL_CODE(data, PV_EINK_ODD_MASK_D, set, clear)))
+#define PV_EINK_EVEN_BYTE(data, set, clear) (uint8_t)(                        \
+    (PV_EINK_PIXEL_CODE(data, PV_EINK_EVEN_MASK_A, set, clear))      |        \
+    (PV_EINK_PIXEL_CODE(data, PV_EINK_EVEN_MASK_B, set, clear) << 2) |        \
+    (PV_EINK_PIXEL_CODE(data, PV_EINK_EVEN_MASK_C, set, clear) << 4) |        \
+    (PV_EINK_PIXEL_CODE(data, PV_EINK_EVEN_MASK_D, set, clear) << 6))
+
+/* Stage 1: inverted previous image, Stage 2: all-white frame, Stage 3: 
+   inverted new image, Stage 4: new image */
+#define PV_EINK_STAGE1_ODD(data)   PV_EINK_ODD_BYTE(data, PV_EINK_BLACK0, PV_EINK_WHITE0)
+#define PV_EINK_STAGE1_EVEN(data)  PV_EINK_EVEN_BYTE(data, PV_EINK_BLACK0, PV_EINK_WHITE0)
+#define PV_EINK_STAGE2_ODD(data)   PV_EINK_ODD_BYTE(data, PV_EINK_WHITE0, PV_EINK_NOTHING0)
+#define PV_EINK_STAGE2_EVEN(data)  PV_EINK_EVEN_BYTE(data, PV_EINK_WHITE0, PV_EINK_NOTHING0)
+#define PV_EINK_STAGE3_ODD(data)   PV_EINK_ODD_BYTE(data, PV_EINK_BLACK0, PV_EINK_NOTHING0)
+#define PV_EINK_STAGE3_EVEN(data)  PV_EINK_EVEN_BYTE(data, PV_EINK_BLACK0, PV_EINK_NOTHING0)
+#define PV_EINK_STAGE4_ODD(data)   PV_EINK_ODD_BYTE(data, PV_EINK_WHITE0, PV_EINK_BLACK0)
+#define PV_EINK_STAGE4_EVEN(data)  PV_EINK_EVEN_BYTE(data, PV_EINK_WHITE0, PV_EINK_BLACK0)
+
+/* Pixel masks used by the partial update */
+#define PV_EINK_PIXEL_ODD_MASK(data)   PV_EINK_ODD_BYTE(data, 0x03u, 0x00u)
+#define PV_EINK_PIXEL_EVEN_MASK(data)  PV_EINK_EVEN_BYTE(data, 0x03u, 0x00u)
+
+/* Initializers of the 256-entry lookup tables */
+#define PV_EINK_LUT_4(F, n)    F(n), F((n) + 1u), F((n) + 2u), F((n) + 3u)
+#define PV_EINK_LUT_16(F, n)   PV_EINK_LUT_4(F, n),         PV_EINK_LUT_4(F, (n) + 4u), \
+                               PV_EINK_LUT_4(F, (n) + 8u),  PV_EINK_LUT_4(F, (n) + 12u)
+#define PV_EINK_LUT_64(F, n)   PV_EINK_LUT_16(F, n),        PV_EINK_LUT_16(F, (n) + 16u), \
+                               PV_EINK_LUT_16(F, (n) + 32u), PV_EINK_LUT_16(F, (n) + 48u)
+#define PV_EINK_LUT_256(F)     PV_EINK_LUT_64(F, 0u),       PV_EINK_LUT_64(F, 64u), \
+                               PV_EINK_LUT_64(F, 128u),     PV_EINK_LUT_64(F, 192u)
+
 /* Line data structure of 2.7" display. Refer to driver document Section 5.1 
    for details */
 struct eink_lineData
@@ -77,9 +131,23 @@ typedef union
     /* The maximum line buffer data size as length */
 }   driver_data_packet_t;
 
-/* Variable that stores the packets for one full drive frame. This variable
-   is used for full and partial updates */
-driver_data_packet_t  bulkDriverPacket[PV_EINK_VERTICAL_SIZE];
+/* Ring of line buffers used for full and partial updates. Each line is encoded 
+   just in time while the previous lines are being transmitted */
+driver_data_packet_t  static lineRing[PV_EINK_LINE_RING_SIZE];
+
+/* Index of the most recently used buffer of the line ring */
+uint8_t static              lineRingIndex;
+
+/* Region that covers the whole display */
+pv_eink_region_t const      fullRegion = {0u, PV_EINK_HORIZONTAL_SIZE - 1u,
+                                          0u, PV_EINK_VERTICAL_SIZE - 1u};
+
+/* Bitmap of the lines that differ between the previous and the new image of a
+   partial update */
+uint8_t static              dirtyRows[PV_EINK_ROW_BITMAP_SIZE];
+
+/* Image line used to encode the white and black frames */
+uint8_t static              solidImageLine[PV_EINK_HORIZONTAL_SIZE];
 
 /* Variable that stores a single line data. This variable is used to prepare 
    dummy frames */
@@ -89,19 +157,83 @@ driver_data_packet_t  static driverPacket;
 uint8_t const               scanTable[PV_EINK_SCAN_TABLE_SIZE] =
                             PV_EINK_SCAN_TABLE_DATA;
 
+/* Odd and Even data bytes of the four full update stages, indexed by the image
+   data byte. The tables are generated at compile time and stored in flash */
+uint8_t const               stageOddTable[PV_EINK_STAGE_COUNT][PV_EINK_LUT_SIZE] =
+{
+    {PV_EINK_LUT_256(PV_EINK_STAGE1_ODD)},
+    {PV_EINK_LUT_256(PV_EINK_STAGE2_ODD)},
+    {PV_EINK_LUT_256(PV_EINK_STAGE3_ODD)},
+    {PV_EINK_LUT_256(PV_EINK_STAGE4_ODD)}
+};
+uint8_t const               stageEvenTable[PV_EINK_STAGE_COUNT][PV_EINK_LUT_SIZE] =
+{
+    {PV_EINK_LUT_256(PV_EINK_STAGE1_EVEN)},
+    {PV_EINK_LUT_256(PV_EINK_STAGE2_EVEN)},
+    {PV_EINK_LUT_256(PV_EINK_STAGE3_EVEN)},
+    {PV_EINK_LUT_256(PV_EINK_STAGE4_EVEN)}
+};
+
+/* Pixel masks of the Odd and Even data bytes, indexed by the image data byte.
+   Each set image bit selects the two bits of its pixel */
+uint8_t const               pixelOddMaskTable[PV_EINK_LUT_SIZE] =
+                            {PV_EINK_LUT_256(PV_EINK_PIXEL_ODD_MASK)};
+uint8_t const               pixelEvenMaskTable[PV_EINK_LUT_SIZE] =
+                            {PV_EINK_LUT_256(PV_EINK_PIXEL_EVEN_MASK)};
+
 /* The SPI register addresses for Channel Select */
 uint8_t const               channelSelect[PV_EINK_CHANNEL_SEL_SIZE] =
                             PV_EINK_CHANNEL_SEL_DATA;
 
-/* Variables that store the driver timing information */
-uint16_t static             fullUpdateTime;
-uint16_t static             partialUpdateTime;
+/* Transaction headers used to stream the data lines asynchronously */
+uint8_t static              pixelDataIndex[] = {PV_EINK_REG_INDEX_HEADER,
+                                                PV_EINK_PIXEL_DATA_COMMAND_INDEX};
+uint8_t static              dataWriteHeader[] = {PV_EINK_REG_DATA_WRITE};
+uint8_t static              enableOeIndex[] = {PV_EINK_REG_INDEX_HEADER,
+                                               PV_EINK_ENABLE_OE_COMMAND_INDEX};
+uint8_t static              enableOeData[] = {PV_EINK_REG_DATA_WRITE,
+                                              PV_EINK_ENABLE_OE_COMMAND_DATA};
+
+/* Variables that store the driver timing information, in E-INK timer ticks */
+uint32_t static             fullUpdateTime;
+uint32_t static             partialUpdateTime;
 
 /* Pointers for the data structures used by the driver */
 uint8_t static*             dataLineEven;
 uint8_t static*             dataLineOdd;
 uint8_t static*             dataLineScan;
 
+/* First SPI queue failure since the power on, reported at the power off */
+pv_eink_status_t static     spiStatus;
+
+#ifdef CY_EINK_BENCHMARK
+/* Costs of the recorded stages and of the stage in progress */
+pv_eink_bench_stage_t static benchStages[PV_EINK_BENCH_MAX_STAGES];
+uint8_t static              benchStageCount;
+pv_eink_bench_stage_t static benchStage;
+
+/* CPU cycle counter at the start of the line preparation */
+uint32_t static             benchEncodeStart;
+
+/* Hooks of the stage handlers that record the stage costs */
+#define PV_EINK_BENCH_STAGE_START       memset(&benchStage, 0, sizeof(benchStage))
+#define PV_EINK_BENCH_ENCODE_START      (benchEncodeStart = Cy_EINK_GetCycleCount())
+#define PV_EINK_BENCH_ENCODE_END(lines) Pv_EINK_BenchEncodeEnd(lines)
+#define PV_EINK_BENCH_PASS              (benchStage.passCount++)
+#define PV_EINK_BENCH_STAGE_END         Pv_EINK_BenchStageEnd()
+
+static void Pv_EINK_BenchEncodeEnd(uint16_t lines);
+static void Pv_EINK_BenchStageEnd(void);
+#else
+#define PV_EINK_BENCH_STAGE_START
+#define PV_EINK_BENCH_ENCODE_START
+#define PV_EINK_BENCH_ENCODE_END(lines)
+#define PV_EINK_BENCH_PASS
+#define PV_EINK_BENCH_STAGE_END
+#endif /* CY_EINK_BENCHMARK */
+
+static void Pv_EINK_CheckSPI(bool sent);
+
 /*******************************************************************************
 * Function Name: void Pv_EINK_SendData(uint8_t regAddr, uint8_t* data, 
 *                                   uint16_t dataLength)
@@ -122,6 +254,9 @@ uint8_t static*             dataLineScan;
 *******************************************************************************/
 void Pv_EINK_SendData(uint8_t regAddr, uint8_t* data, uint16_t dataLength)
 {
+    /* Let the streamed data lines finish before taking over the SPI */
+    Pv_EINK_CheckSPI(Cy_EINK_WaitSPIQueue(0u));
+    
     /* Pull the chip select line LOW to begin communication */
     CY_EINK_CsLow;
     /* Send the header of register address index */
@@ -198,6 +333,9 @@ uint8_t Pv_EINK_ReadByte(uint8_t regAddr, uint8_t data)
     /* Variable that stores received data */
     uint8_t dataRead;
     
+    /* Let the streamed data lines finish before taking over the SPI */
+    Pv_EINK_CheckSPI(Cy_EINK_WaitSPIQueue(0u));
+    
     /* Pull the chip select line LOW to begin communication */
     CY_EINK_CsLow;
     /* Send the header of register address index */
@@ -224,21 +362,82 @@ uint8_t Pv_EINK_ReadByte(uint8_t regAddr, uint8_t data)
 }
 
 /*******************************************************************************
-* Function Name: void  Pv_EINK_Init()
+* Function Name: static void Pv_EINK_CheckSPI(bool sent)
 ********************************************************************************
 *
-* Summary: Initialize the E-INK display hardware and associated PSoC components.
+* Summary: Keeps the first failure of the asynchronous SPI queue, so that the
+* update is reported as failed when the display is powered off.
 *
 * Parameters:
+*  bool sent : Result of the SPI queue operation
+*
+* Return:
 *  None
 *
+* Side Effects:
+*  None
+*******************************************************************************/
+static void Pv_EINK_CheckSPI(bool sent)
+{
+    if (!sent)
+    {
+        spiStatus = PV_EINK_ERROR_SPI;
+    }
+}
+
+/*******************************************************************************
+* Function Name: void Pv_EINK_StreamLine(uint8_t* lineBuffer)
+********************************************************************************
+*
+* Summary: Queues a data line followed by the Output Enable command for 
+* asynchronous transmission. The lines are chained back-to-back by the SPI 
+* interrupt, so the calling task sleeps while they are being sent.
+*
+* Parameters:
+*  uint8_t* lineBuffer : Pointer to the data line. The buffer must not be 
+*                        modified until the line has been sent.
+*
 * Return:
 *  None
 *
 * Side Effects:
+*  Blocks while the SPI queue is full. Once the queue has failed, the lines are
+*  not sent until the next power on
+*******************************************************************************/
+static void Pv_EINK_StreamLine(uint8_t* lineBuffer)
+{
+    if (spiStatus != PV_EINK_RES_OK)
+    {
+        return;
+    }
+    
+    /* Send the line data to the E-INK display, then turn on Output Enable to
+       latch the line. A failed transaction ends the line */
+    Pv_EINK_CheckSPI(
+        Cy_EINK_QueueSPIBuffer(pixelDataIndex, sizeof(pixelDataIndex), NULL, 0u) &&
+        Cy_EINK_QueueSPIBuffer(dataWriteHeader, sizeof(dataWriteHeader),
+                               lineBuffer, PV_EINK_DATA_LINE_SIZE) &&
+        Cy_EINK_QueueSPIBuffer(enableOeIndex, sizeof(enableOeIndex), NULL, 0u) &&
+        Cy_EINK_QueueSPIBuffer(enableOeData, sizeof(enableOeData), NULL, 0u));
+}
+
+/*******************************************************************************
+* Function Name: pv_eink_status_t Pv_EINK_Init()
+********************************************************************************
+*
+* Summary: Initialize the E-INK display hardware and associated PSoC components.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  pv_eink_status_t : PV_EINK_ERROR_TIMER if the E-INK timer could not be 
+*                     started, PV_EINK_RES_OK otherwise
+*
+* Side Effects:
 *  None
 *******************************************************************************/
-void Pv_EINK_Init(void)
+pv_eink_status_t Pv_EINK_Init(void)
 {
     /* Enable the level translator located between PSoC and the E-INK display */
     CY_EINK_EnableIO;
@@ -255,7 +454,58 @@ void Pv_EINK_Init(void)
     CY_EINK_DischargeLow;
     
     /* Initialize the E-INK display Timer */
+    if (!Cy_EINK_StartTimer())
+    {
+        return(PV_EINK_ERROR_TIMER);
+    }
     Cy_EINK_TimerInit();
+    
+    return(PV_EINK_RES_OK);
+}
+
+/*******************************************************************************
+* Function Name: bool Pv_EINK_PollDCLevel(void)
+********************************************************************************
+*
+* Summary: Polls the DC level of the charge pump. The first check is made after
+* a short delay and the interval doubles after each check, until the DC level 
+* is reached or the power control delay has elapsed.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool: True if the DC level has been reached, False otherwise
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static bool Pv_EINK_PollDCLevel(void)
+{
+    /* Time waited so far and the next polling interval, in mS */
+    uint16_t    waitTime = 0u;
+    uint16_t    pollDelay = PV_EINK_DC_LEVEL_POLL_DELAY;
+    
+    while (waitTime < PV_EINK_PWR_CTRL_DELAY)
+    {
+        if (pollDelay > (PV_EINK_PWR_CTRL_DELAY - waitTime))
+        {
+            pollDelay = PV_EINK_PWR_CTRL_DELAY - waitTime;
+        }
+        CY_EINK_Delay(pollDelay);
+        waitTime += pollDelay;
+        pollDelay <<= 1u;
+        
+        if ((Pv_EINK_ReadByte(PV_EINK_DC_LEVEL_READ_COMMAND_INDEX,
+                              PV_EINK_DC_LEVEL_READ_COMMAND_DATA) & 
+                              PV_EINK_DC_LEVEL_MASK)
+                              != PV_EINK_DC_LEVEL_CHECK)
+        {
+            return(true);
+        }
+    }
+    
+    return(false);
 }
 
 /*******************************************************************************
@@ -287,23 +537,13 @@ pv_eink_status_t Pv_EINK_InitDriver(void)
     dataLineOdd  = &driverPacket.lineDataBySize.odd[0];
     dataLineScan = &driverPacket.lineDataBySize.scan[0];
     
-    /* Initialize and start the E-INK Timer   */
-    Cy_EINK_TimerInit();
-        
-    /* Check if E-INK driver is busy */
-    while (Cy_EINK_IsBusy())
+    /* Wait until the E-INK driver is ready. If the E-INK driver is busy for 
+       more than maximum allowed time, return an error message */
+    if (!Cy_EINK_WaitWhileBusy(PV_EINK_MAX_PV_EINK_BUSY_TIME))
     {
-        /* If the E-INK driver is busy for more than maximum allowed time,
-           return an error message */
-        if (Cy_EINK_GetTimeTick() >= PV_EINK_MAX_PV_EINK_BUSY_TIME)
-        {
-            return(PV_EINK_ERROR_BUSY);
-        }
+        return(PV_EINK_ERROR_BUSY);
     }
     
-    /* Stop the E-INK Timer */
-    Cy_EINK_TimerStop();
-    
     /* Check the driver ID */
     if ((Pv_EINK_ReadByte(PV_EINK_DRIVER_ID_COMMAND_INDEX, 
                           PV_EINK_DRIVER_ID_COMMAND_DATA)
@@ -372,13 +612,10 @@ pv_eink_status_t Pv_EINK_InitDriver(void)
         /* Set charge pump (Vcom_Driver on) */
         Pv_EINK_SendByte(PV_EINK_VCOM_DRIVE_ON_COMMAND_INDEX,
                       PV_EINK_VCOM_DRIVE_ON_COMMAND_DATA);
-        CY_EINK_Delay(PV_EINK_PWR_CTRL_DELAY);
         
-        /* Check DC level */
-        if ((Pv_EINK_ReadByte(PV_EINK_DC_LEVEL_READ_COMMAND_INDEX,
-                           PV_EINK_DC_LEVEL_READ_COMMAND_DATA) & 
-                           PV_EINK_DC_LEVEL_MASK)
-                           != PV_EINK_DC_LEVEL_CHECK)
+        /* Check DC level, as soon as it is ready but no longer than the power 
+           control delay */
+        if (Pv_EINK_PollDCLevel())
         {
             /* Disable OLE */
             Pv_EINK_SendByte(PV_EINK_DISABLE_OE_COMMAND_INDEX,
@@ -455,8 +692,306 @@ void Pv_EINK_SetTempFactor(int8_t temperature)
         updateTime = PV_EINK_TEMP_SEL7;
     }
     /* Scale the update times : this is a speed-contrast trade-off */
-    fullUpdateTime = updateTime * PV_EINK_SCALING_FULL;
-    partialUpdateTime = updateTime * PV_EINK_SCALING_PARTIAL;
+    fullUpdateTime = (uint32_t)updateTime * PV_EINK_SCALING_FULL * 
+                     CY_EINK_TICKS_PER_MS;
+    partialUpdateTime = (uint32_t)updateTime * PV_EINK_SCALING_PARTIAL *
+                        CY_EINK_TICKS_PER_MS;
+}
+
+/*******************************************************************************
+* Function Name: driver_data_packet_t* Pv_EINK_NextRingPacket(void)
+********************************************************************************
+*
+* Summary: Returns the next buffer of the line ring with its previous content.
+* The buffer is reused only after the line previously encoded into it has been 
+* sent.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  driver_data_packet_t* : Pointer to a free line buffer
+*
+* Side Effects:
+*  Blocks while all the ring buffers are still queued for transmission
+*******************************************************************************/
+static driver_data_packet_t* Pv_EINK_NextRingPacket(void)
+{
+    /* Move onto the next buffer of the ring */
+    lineRingIndex = (lineRingIndex + 1u) % PV_EINK_LINE_RING_SIZE;
+    
+    /* The lines queued after this buffer was used occupy at most the other 
+       buffers of the ring. Wait until only those are pending */
+    Pv_EINK_CheckSPI(Cy_EINK_WaitSPIQueue(PV_EINK_LINE_TRANSACTIONS * 
+                                          (PV_EINK_LINE_RING_SIZE - 1u)));
+    
+    return(&lineRing[lineRingIndex]);
+}
+
+/*******************************************************************************
+* Function Name: driver_data_packet_t* Pv_EINK_NextLinePacket(void)
+********************************************************************************
+*
+* Summary: Returns the next buffer of the line ring, cleared to all zeros.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  driver_data_packet_t* : Pointer to a free line buffer
+*
+* Side Effects:
+*  Blocks while all the ring buffers are still queued for transmission
+*******************************************************************************/
+static driver_data_packet_t* Pv_EINK_NextLinePacket(void)
+{
+    /* Pointer to the line buffer being prepared */
+    driver_data_packet_t* packet = Pv_EINK_NextRingPacket();
+    
+    /* Clear the line buffer with all zeros */
+    memset(&packet->lineBuffer, 0, sizeof(packet->lineBuffer));
+    
+    return(packet);
+}
+
+/*******************************************************************************
+* Function Name: void Pv_EINK_SetScanByte(driver_data_packet_t* packet,
+*                                         uint16_t lineNumber)
+********************************************************************************
+*
+* Summary: Sets the scan byte that selects the given line of the display.
+*
+* Parameters:
+*  driver_data_packet_t* packet : Line buffer to update
+*  uint16_t lineNumber          : Line number counted from the top of the image
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static void Pv_EINK_SetScanByte(driver_data_packet_t* packet, uint16_t lineNumber)
+{
+    /* Variable for storing the line number under scan */
+    int16       scanlineNumber;
+    
+    /* Scan lines are numbered from the bottom of the image */
+    scanlineNumber = PV_EINK_VERTICAL_SIZE - lineNumber;
+    scanlineNumber--;
+    
+    /* Shift Scan byte according to the data line */
+    packet->lineDataBySize.scan[(scanlineNumber >> PV_EINK_PIXEL_SIZE)] = 
+                        scanTable[(scanlineNumber % PV_EINK_SCAN_TABLE_SIZE)];
+}
+
+/*******************************************************************************
+* Function Name: void Pv_EINK_EncodeStageLine(driver_data_packet_t* packet,
+*                  pv_eink_frame_data_t* linePtr, pv_eink_stage_t stageNumber)
+********************************************************************************
+*
+* Summary: Converts one line of image data to the Odd and Even bytes of the 
+* given full update stage, using the lookup tables of the stage.
+*
+* Parameters:
+*  driver_data_packet_t* packet   : Line buffer that receives the data bytes
+*  pv_eink_frame_data_t* linePtr  : Pointer to the first image byte of the line
+*  pv_eink_stage_t stageNumber    : The assigned stage number
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static void Pv_EINK_EncodeStageLine(driver_data_packet_t* packet,
+                                    pv_eink_frame_data_t* linePtr,
+                                    pv_eink_stage_t stageNumber)
+{
+    /* Counter variable for the horizontal pixel loop */
+    uint16_t    x;
+    /* Counter variable for the horizontal byte loop */
+    uint16_t    k;
+    
+    /* Temporary storage for image data byte */
+    uint8_t     tempByte;
+    
+    /* Lookup tables of the stage */
+    uint8_t const* oddTable = stageOddTable[stageNumber];
+    uint8_t const* evenTable = stageEvenTable[stageNumber];
+    
+    /* Initialize the even data and odd data pointers */
+    dataLineEven = &packet->lineDataBySize.even[0];
+    dataLineOdd  = &packet->lineDataBySize.odd[0];
+    
+    /* Horizontal bytes initialization */
+    k = PV_EINK_HORIZONTAL_SIZE;
+    k--;
+    
+    /* Horizontal pixel loop */
+    for (x = 0; x < PV_EINK_HORIZONTAL_SIZE; x++)
+    {
+        /* Fetch successive data bytes */
+        tempByte = *linePtr++;
+        
+        /* Odd bytes run left to right and Even bytes right to left */
+        dataLineOdd[x]    = oddTable[tempByte];
+        dataLineEven[k--] = evenTable[tempByte];
+    }
+}
+
+/*******************************************************************************
+* Function Name: void Pv_EINK_EncodePartialLine(driver_data_packet_t* packet,
+*            pv_eink_frame_data_t* previousLinePtr, pv_eink_frame_data_t* newLinePtr)
+********************************************************************************
+*
+* Summary: Converts one line of image data to the Odd and Even bytes of the 
+* partial update stage.
+*
+* The changed pixels take the stage 4 codes of the new image and the unchanged
+* pixels the "nothing" code. The selection is done with the pixel masks of the 
+* changed bits, so no table indexed by both bytes is needed.
+*
+* Parameters:
+*  driver_data_packet_t* packet          : Line buffer that receives the data
+*  pv_eink_frame_data_t* previousLinePtr : First byte of the line in the 
+*                                          previous image
+*  pv_eink_frame_data_t* newLinePtr      : First byte of the line in the new 
+*                                          image
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static void Pv_EINK_EncodePartialLine(driver_data_packet_t* packet,
+                                      pv_eink_frame_data_t* previousLinePtr,
+                                      pv_eink_frame_data_t* newLinePtr)
+{
+    /* Counter variable for the horizontal pixel loop */
+    uint16_t    x;
+    /* Counter variable for the horizontal byte loop */
+    uint16_t    k;
+    
+    /* Temporary storage for image data bytes */
+    uint8_t     newByte;
+    /* Temporary storage for the changed bits of the image data bytes */
+    uint8_t     changedBits;
+    
+    /* Temporary storage for the pixel masks of the changed bits */
+    uint8_t     oddMask;
+    uint8_t     evenMask;
+    
+    /* Initialize the even data and odd data pointers */
+    dataLineEven = &packet->lineDataBySize.even[0];
+    dataLineOdd  = &packet->lineDataBySize.odd[0];
+    
+    /* Horizontal bytes initialization */
+    k = PV_EINK_HORIZONTAL_SIZE;
+    k--;
+    
+    /* Horizontal pixel loop */
+    for (x = 0; x < PV_EINK_HORIZONTAL_SIZE; x++)
+    {
+        /* Fetch successive data bytes */
+        newByte = *newLinePtr++;
+        changedBits = *previousLinePtr++ ^ newByte;
+        
+        /* If the new data bit is same as the previous data bit, store a 
+           "nothing" pixel, so that the E-INK pixel won't be altered.
+           If the new data bit is different from the previous data bit, 
+           store the new data bit */
+        oddMask  = pixelOddMaskTable[changedBits];
+        evenMask = pixelEvenMaskTable[changedBits];
+        
+        dataLineOdd[x]    = (stageOddTable[PV_EINK_STAGE4][newByte] & oddMask) |
+                            (PV_EINK_NOTHING & (uint8_t)~oddMask);
+        dataLineEven[k--] = (stageEvenTable[PV_EINK_STAGE4][newByte] & evenMask) |
+                            (PV_EINK_NOTHING & (uint8_t)~evenMask);
+    }
+}
+
+/*******************************************************************************
+* Function Name: void Pv_EINK_MaskLine(driver_data_packet_t* packet,
+*                                      pv_eink_region_t const* region)
+********************************************************************************
+*
+* Summary: Replaces the Odd and Even bytes outside the horizontal range of a 
+* region with "nothing" bytes, so that those pixels are not altered.
+*
+* Parameters:
+*  driver_data_packet_t* packet     : Encoded line buffer
+*  pv_eink_region_t const* region   : Region that is being driven
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static void Pv_EINK_MaskLine(driver_data_packet_t* packet,
+                             pv_eink_region_t const* region)
+{
+    /* Counter variable for the horizontal pixel loop */
+    uint16_t    x;
+    
+    for (x = 0; x < PV_EINK_HORIZONTAL_SIZE; x++)
+    {
+        if ((x < region->firstByte) || (x > region->lastByte))
+        {
+            /* Odd bytes run left to right and Even bytes right to left */
+            packet->lineDataBySize.odd[x] = PV_EINK_NOTHING;
+            packet->lineDataBySize.even[PV_EINK_HORIZONTAL_SIZE - 1u - x] = 
+                                                                PV_EINK_NOTHING;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: void Pv_EINK_WaitPassEnd(uint32_t passStart, 
+*                                     uint16_t lineCount, uint32_t stageTime)
+********************************************************************************
+*
+* Summary: Waits until the lines of a pass have been sent and then sleeps for
+* the time the other lines of a whole-frame pass would have taken, without 
+* exceeding the stage time.
+*
+* Parameters:
+*  uint32_t passStart    : E-INK timer tick at the start of the pass
+*  uint16_t lineCount    : Number of lines sent in the pass
+*  uint32_t stageTime    : Duration of the stage in E-INK timer ticks
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static void Pv_EINK_WaitPassEnd(uint32_t passStart, uint16_t lineCount,
+                                uint32_t stageTime)
+{
+    /* Timing of the pass, in E-INK timer ticks */
+    uint32_t    passEnd;
+    uint32_t    currentTime;
+    
+    /* Wait until the lines of the pass have been sent */
+    Pv_EINK_CheckSPI(Cy_EINK_WaitSPIQueue(0u));
+    currentTime = Cy_EINK_GetTimeTick();
+    
+    /* Scale the duration of the pass to a whole-frame pass */
+    passEnd = passStart + (((currentTime - passStart) * PV_EINK_VERTICAL_SIZE) /
+                           lineCount);
+    if (passEnd > stageTime)
+    {
+        passEnd = stageTime;
+    }
+    if (passEnd > currentTime)
+    {
+        /* Sleep for the whole milliseconds and wait for the rest */
+        CY_EINK_Delay((passEnd - currentTime) / CY_EINK_TICKS_PER_MS);
+        Cy_EINK_DelayUs((passEnd - currentTime) % CY_EINK_TICKS_PER_MS);
+    }
 }
 
 /*******************************************************************************
@@ -483,200 +1018,215 @@ void Pv_EINK_SetTempFactor(int8_t temperature)
 *  None
 *
 * Side Effects:
-*  This is a blocking function. CPU will be busy during the entire operation,
-* which can be 1 to 2 seconds.
+*  This is a blocking function that can take 1 to 2 seconds. The data lines are
+* streamed by the SPI interrupt, so the calling task sleeps for most of it.
 *******************************************************************************/
 void Pv_EINK_FullStageHandler(pv_eink_frame_data_t* imagePtr, 
                               pv_eink_stage_t stageNumber)
 {
-    /* Counter variable for the horizontal pixel loop */
-    uint16_t    x;
+    Pv_EINK_FullStageRegionHandler(imagePtr, stageNumber, &fullRegion);
+}
+
+/*******************************************************************************
+* Function Name: void Pv_EINK_FullStageRegionHandler(pv_eink_frame_data_t* 
+*       imagePtr, pv_eink_stage_t stageNumber, pv_eink_region_t const* region)
+********************************************************************************
+*
+* Summary: Performs a full update driving stage on a region of the display.
+*
+* Each line of the region is encoded just in time into the line ring while the
+* previous lines are being transmitted, so no full drive frame is kept in RAM.
+* The lines of the white and the black frames are all the same: such a line is
+* encoded once into every buffer of the ring and only its scan byte changes.
+* The pixels left and right of the region are sent as "nothing" pixels and the
+* lines above and below it are not sent at all.
+*
+* When the region does not cover all the lines, each pass sends the lines of
+* the region and then sleeps for the time the other lines would have taken, so
+* the region sees the same drive timing as a whole-frame update.
+*
+* Parameters:
+* pv_eink_frame_data_t* imagePtr    : The pointer to the memory that contains a
+*                                     frame
+* pv_eink_stage_t stageNumber       : The assigned stage number
+* pv_eink_region_t const* region    : Lines and bytes of the frame to drive
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  This is a blocking function that can take 1 to 2 seconds. The data lines are
+* streamed by the SPI interrupt, so the calling task sleeps for most of it.
+*******************************************************************************/
+void Pv_EINK_FullStageRegionHandler(pv_eink_frame_data_t* imagePtr, 
+                                    pv_eink_stage_t stageNumber,
+                                    pv_eink_region_t const* region)
+{
     /* Counter variable for the vertical pixel loop */
     uint16_t    y;
-    /* Counter variable for the horizontal byte loop */
-    uint16_t    k;
-      
-    /* Variable for storing the line number under scan */
-    int16       scanlineNumber = 0;
     
-    /* Temporary storage for image data byte */
-    uint8_t     tempByte = *imagePtr;
+    /* Pointer to the line buffer being prepared */
+    driver_data_packet_t* packet;
+    
+    /* Counter variable for the line ring */
+    uint8_t     ringCounter;
     
-    /* Flag to check if the current pointer is a macro of white/black frame */
-    bool        blackOrWhiteFrame;
+    /* Flag that indicates the white or the black frame */
+    bool        solidFrame = false;
     
-    /* If the current pointer is a macro of the white frame */
-    if (imagePtr == PV_EINK_WHITE_FRAME_ADDRESS)
+    /* Number of lines of the region */
+    uint16_t    lineCount = region->lastLine - region->firstLine + 1u;
+    
+    /* Flag that indicates a region narrower than the display */
+    bool        maskLine = (region->firstByte != 0u) || 
+                           (region->lastByte != (PV_EINK_HORIZONTAL_SIZE - 1u));
+    
+    /* E-INK timer tick at the start of a pass */
+    uint32_t    passStart;
+    
+    PV_EINK_BENCH_STAGE_START;
+    
+    /* If the current pointer is a macro of the white or the black frame, 
+       encode a single line of white or black pixel bytes into every buffer of
+       the line ring */
+    if ((imagePtr == PV_EINK_WHITE_FRAME_ADDRESS) ||
+        (imagePtr == PV_EINK_BLACK_FRAME_ADDRESS))
     {
-        /* Set the white/black frame flag */
-        blackOrWhiteFrame = true;
-        /* Set the tempByte to white pixel byte */
-        tempByte = PV_EINK_WHITE_PIXEL_BYTE;
+        PV_EINK_BENCH_ENCODE_START;
+        memset(solidImageLine, (imagePtr == PV_EINK_WHITE_FRAME_ADDRESS) ?
+               PV_EINK_WHITE_PIXEL_BYTE : PV_EINK_BLACK_PIXEL_BYTE,
+               sizeof(solidImageLine));
         
-    }
-    /* If the current pointer is a macro of the black frame */
-    else if (imagePtr == PV_EINK_BLACK_FRAME_ADDRESS)
-    {
-         /* Set the white/black frame flag */
-        blackOrWhiteFrame = true;
-        /* set the tempByte to black pixel byte */
-        tempByte = PV_EINK_BLACK_PIXEL_BYTE;
-    }
-    /* If the current pointer is of an image stored in flash */
-    else
-    {
-        /* Clear the white/black frame flag */
-        blackOrWhiteFrame = false;
+        /* Wait until no buffer of the ring is in use */
+        Pv_EINK_CheckSPI(Cy_EINK_WaitSPIQueue(0u));
+        
+        memset(&lineRing[0].lineBuffer, 0, sizeof(lineRing[0].lineBuffer));
+        Pv_EINK_EncodeStageLine(&lineRing[0], solidImageLine, stageNumber);
+        if (maskLine)
+        {
+            Pv_EINK_MaskLine(&lineRing[0], region);
+        }
+        for (ringCounter = 1u; ringCounter < PV_EINK_LINE_RING_SIZE; 
+             ringCounter++)
+        {
+            lineRing[ringCounter] = lineRing[0];
+        }
+        solidFrame = true;
+        PV_EINK_BENCH_ENCODE_END(0u);
     }
 
     /* Re-initialize E-INK timer to ensure the same duration of each stage */
     Cy_EINK_TimerInit();
-
-    /* Vertical pixel loop */
-    for (y = 0; y < PV_EINK_VERTICAL_SIZE; y++)
+    
+    /* Perform the update operation until the total time of frames exceed 
+       stage time */
+    do
     {
-        /* Clear the line buffer with all zeros */
-        memset(&bulkDriverPacket[y].lineBuffer, 0, 
-               sizeof(bulkDriverPacket[y].lineBuffer)) ;
-
-        /* Initialize the even data, odd data and scan data pointers */
-        dataLineEven = &bulkDriverPacket[y].lineDataBySize.even[0];
-        dataLineOdd  = &bulkDriverPacket[y].lineDataBySize.odd[0];
-        dataLineScan = &bulkDriverPacket[y].lineDataBySize.scan[0];
-        
-        /* Horizontal bytes initialization */
-        k = PV_EINK_HORIZONTAL_SIZE;
-        k--;
+        passStart = Cy_EINK_GetTimeTick();
+        PV_EINK_BENCH_PASS;
         
-        /* Horizontal pixel loop */
-        for (x = 0; x < PV_EINK_HORIZONTAL_SIZE; x++)
+        /* Perform a line by line update */
+        for (y = region->firstLine; y <= region->lastLine; y++)
         {
-            /* If the current pointer is of an image stored in flash */
-            if(!blackOrWhiteFrame)
+            PV_EINK_BENCH_ENCODE_START;
+            if (solidFrame)
             {
-                /* Fetch successive data bytes */
-                tempByte = *imagePtr++;
+                /* Reuse the encoded line; only clear the previous scan byte */
+                packet = Pv_EINK_NextRingPacket();
+                memset(&packet->lineDataBySize.scan, PV_EINK_SCAN_BYTE_INIT,
+                       sizeof(packet->lineDataBySize.scan));
             }
-            /* Perform one of the four stage operations */
-            switch (stageNumber)
+            else
             {
-            /* Stage 1: Calculate the inverted Even and Odd bytes of 
-               the previous image data */
-            case PV_EINK_STAGE1:
-                dataLineOdd[x]       = ((tempByte & PV_EINK_ODD_MASK_A)  ? 
-                                        PV_EINK_BLACK3 : PV_EINK_WHITE3);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_B)  ? 
-                                        PV_EINK_BLACK2 : PV_EINK_WHITE2);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_C)  ? 
-                                        PV_EINK_BLACK1 : PV_EINK_WHITE1);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_D)  ? 
-                                        PV_EINK_BLACK0 : PV_EINK_WHITE0);
-                dataLineEven[k]      = ((tempByte & PV_EINK_EVEN_MASK_A) ? 
-                                        PV_EINK_BLACK0 : PV_EINK_WHITE0);
-                dataLineEven[k]     |= ((tempByte & PV_EINK_EVEN_MASK_B) ? 
-                                        PV_EINK_BLACK1 : PV_EINK_WHITE1);
-                dataLineEven[k]     |= ((tempByte & PV_EINK_EVEN_MASK_C) ? 
-                                        PV_EINK_BLACK2 : PV_EINK_WHITE2);
-                dataLineEven[k--]   |= ((tempByte & PV_EINK_EVEN_MASK_D) ? 
-                                        PV_EINK_BLACK3 : PV_EINK_WHITE3);
-                break;
-            /* Stage 2: Calculate the Even and Odd bytes of an all-white
-               frame */
-            case PV_EINK_STAGE2:
-                dataLineOdd[x]       = ((tempByte & PV_EINK_ODD_MASK_A)  ? 
-                                        PV_EINK_WHITE3 : PV_EINK_NOTHING3);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_B)  ? 
-                                        PV_EINK_WHITE2 : PV_EINK_NOTHING2);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_C)  ? 
-                                        PV_EINK_WHITE1 : PV_EINK_NOTHING1);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_D)  ? 
-                                        PV_EINK_WHITE0 : PV_EINK_NOTHING0);
-                dataLineEven[k]      = ((tempByte & PV_EINK_EVEN_MASK_A) ?
-                                        PV_EINK_WHITE0 : PV_EINK_NOTHING0);
-                dataLineEven[k]     |= ((tempByte & PV_EINK_EVEN_MASK_B) ? 
-                                        PV_EINK_WHITE1 : PV_EINK_NOTHING1);
-                dataLineEven[k]     |= ((tempByte & PV_EINK_EVEN_MASK_C) ? 
-                                        PV_EINK_WHITE2 : PV_EINK_NOTHING2);
-                dataLineEven[k--]   |= ((tempByte & PV_EINK_EVEN_MASK_D) ? 
-                                        PV_EINK_WHITE3 : PV_EINK_NOTHING3);
-                break;
-            /* Stage 3: Calculate the inverted Even and Odd bytes of the
-               new image data */
-            case PV_EINK_STAGE3:
-                dataLineOdd[x]       = ((tempByte & PV_EINK_ODD_MASK_A)  ? 
-                                        PV_EINK_BLACK3 : PV_EINK_NOTHING3);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_B)  ? 
-                                        PV_EINK_BLACK2 : PV_EINK_NOTHING2);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_C)  ?
-                                        PV_EINK_BLACK1 : PV_EINK_NOTHING1);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_D)  ?
-                                        PV_EINK_BLACK0 : PV_EINK_NOTHING0);
-                dataLineEven[k]      = ((tempByte & PV_EINK_EVEN_MASK_A) ?
-                                        PV_EINK_BLACK0 : PV_EINK_NOTHING0);
-                dataLineEven[k]     |= ((tempByte & PV_EINK_EVEN_MASK_B) ? 
-                                        PV_EINK_BLACK1 : PV_EINK_NOTHING1);
-                dataLineEven[k]     |= ((tempByte & PV_EINK_EVEN_MASK_C) ? 
-                                        PV_EINK_BLACK2 : PV_EINK_NOTHING2);
-                dataLineEven[k--]   |= ((tempByte & PV_EINK_EVEN_MASK_D) ? 
-                                        PV_EINK_BLACK3 : PV_EINK_NOTHING3);
-                break;
-            /* Stage 4: Calculate the Even and Odd bytes of new image 
-               data */
-            case PV_EINK_STAGE4:
-                dataLineOdd[x]       = ((tempByte & PV_EINK_ODD_MASK_A)  ? 
-                                        PV_EINK_WHITE3 : PV_EINK_BLACK3);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_B)  ?
-                                        PV_EINK_WHITE2 : PV_EINK_BLACK2);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_C)  ? 
-                                        PV_EINK_WHITE1 : PV_EINK_BLACK1);
-                dataLineOdd[x]      |= ((tempByte & PV_EINK_ODD_MASK_D)  ? 
-                                        PV_EINK_WHITE0 : PV_EINK_BLACK0);
-                dataLineEven[k]     = ((tempByte & PV_EINK_EVEN_MASK_A)  ? 
-                                        PV_EINK_WHITE0 : PV_EINK_BLACK0);
-                dataLineEven[k]     |= ((tempByte & PV_EINK_EVEN_MASK_B) ? 
-                                        PV_EINK_WHITE1 : PV_EINK_BLACK1);
-                dataLineEven[k]     |= ((tempByte & PV_EINK_EVEN_MASK_C) ?
-                                        PV_EINK_WHITE2 : PV_EINK_BLACK2);
-                dataLineEven[k--]   |= ((tempByte & PV_EINK_EVEN_MASK_D) ? 
-                                        PV_EINK_WHITE3 : PV_EINK_BLACK3);
-                break;
+                /* Encode the line into the next free buffer of the ring */
+                packet = Pv_EINK_NextLinePacket();
+                Pv_EINK_EncodeStageLine(packet, 
+                                        &imagePtr[y * PV_EINK_HORIZONTAL_SIZE],
+                                        stageNumber);
+                if (maskLine)
+                {
+                    Pv_EINK_MaskLine(packet, region);
+                }
             }
+            Pv_EINK_SetScanByte(packet, y);
+            PV_EINK_BENCH_ENCODE_END(1u);
+            
+            /* Queue the prepared data and the latch for the E-INK display */
+            Pv_EINK_StreamLine((uint8_t*) &packet->lineBuffer);
         }
-        /* Move onto the next line */
-        scanlineNumber = PV_EINK_VERTICAL_SIZE - y;
-        scanlineNumber--;
         
-        /* Shift Scan byte according to the data line */
-        dataLineScan[(scanlineNumber >> PV_EINK_PIXEL_SIZE)] = scanTable
-                            [(scanlineNumber % PV_EINK_SCAN_TABLE_SIZE)];
-            
-    }
-            
-    /* Perform the update operation until the total time of frames exceed 
-       stage time */
-    do
-    {
-        /* Perform a line by line update */
-        for (y = 0; y < PV_EINK_VERTICAL_SIZE; y++)
+        /* Sleep for the time of the lines outside the region */
+        if (lineCount < PV_EINK_VERTICAL_SIZE)
         {
-                /* Send the prepared data to the E-INK display */
-            Pv_EINK_SendData(PV_EINK_PIXEL_DATA_COMMAND_INDEX,
-                          (uint8_t*) &bulkDriverPacket[y].lineBuffer,
-                          PV_EINK_DATA_LINE_SIZE);
-                          
-            /* Turn on Output Enable to latch the frame */
-            Pv_EINK_SendByte(PV_EINK_ENABLE_OE_COMMAND_INDEX,
-                          PV_EINK_ENABLE_OE_COMMAND_DATA);
+            Pv_EINK_WaitPassEnd(passStart, lineCount, fullUpdateTime);
         }
-    
     }
     /* Loop until the total time of frames exceed stage time */
     while (fullUpdateTime > Cy_EINK_GetTimeTick());
     
+    /* Wait until the last queued line has been sent */
+    Pv_EINK_CheckSPI(Cy_EINK_WaitSPIQueue(0u));
+    PV_EINK_BENCH_STAGE_END;
+    
     /* Stop the E-INK Timer */
     Cy_EINK_TimerStop();
 }
 
+/*******************************************************************************
+* Function Name: uint16_t Pv_EINK_FindDirtyRows(pv_eink_frame_data_t* 
+*                        previousImagePtr, pv_eink_frame_data_t* newImagePtr,
+*                        pv_eink_region_t const* region)
+********************************************************************************
+*
+* Summary: Compares the previous and the new image line by line within a region
+* and flags the lines that changed in the dirty row bitmap.
+*
+* Parameters:
+* pv_eink_frame_data_t* previousImagePtr : The pointer of memory that contains 
+*                                    previous frame written to the E-INK display
+* pv_eink_frame_data_t* newImagePtr      : The pointer of memory that contains a 
+*                       new frame which needs to be written to the E-INK display
+* pv_eink_region_t const* region         : Lines and bytes of the frame to check
+*
+* Return:
+*  uint16_t : Number of changed lines
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static uint16_t Pv_EINK_FindDirtyRows(pv_eink_frame_data_t* previousImagePtr,
+                                      pv_eink_frame_data_t* newImagePtr,
+                                      pv_eink_region_t const* region)
+{
+    /* Counter variable for the vertical pixel loop */
+    uint16_t    y;
+    
+    /* Offset of the first compared byte of the current line */
+    uint16_t    lineOffset;
+    
+    /* Number of compared bytes of a line */
+    uint16_t    lineLength = region->lastByte - region->firstByte + 1u;
+    
+    /* Number of changed lines */
+    uint16_t    dirtyCount = 0u;
+    
+    memset(dirtyRows, 0, sizeof(dirtyRows));
+    
+    for (y = region->firstLine; y <= region->lastLine; y++)
+    {
+        lineOffset = (y * PV_EINK_HORIZONTAL_SIZE) + region->firstByte;
+        
+        if (memcmp(&previousImagePtr[lineOffset], &newImagePtr[lineOffset],
+                   lineLength) != 0)
+        {
+            dirtyRows[y >> 3u] |= (uint8_t)(1u << (y & 7u));
+            dirtyCount++;
+        }
+    }
+    
+    return(dirtyCount);
+}
+
 /*******************************************************************************
 * Function Name:  void Pv_EINK_PartialStageHandler(pv_eink_frame_data_t* 
                             previousImagePtr, pv_eink_frame_data_t* newImagePtr)
@@ -702,144 +1252,162 @@ void Pv_EINK_FullStageHandler(pv_eink_frame_data_t* imagePtr,
 *  None
 *
 * Side Effects:
-*  This is a blocking function. CPU will be busy during the entire operation,
-*  which can be 1 to 2 seconds. 
+*  This is a blocking function that can take 1 to 2 seconds. The data lines are
+*  streamed by the SPI interrupt, so the calling task sleeps for most of it.
+*  Returns at once if the two images are identical.
 *******************************************************************************/
 void Pv_EINK_PartialStageHandler(pv_eink_frame_data_t* previousImagePtr, 
                                  pv_eink_frame_data_t* newImagePtr)
 {
-    /* Counter variable for the horizontal pixel loop */
-    uint16_t    x;
+    Pv_EINK_PartialStageRegionHandler(previousImagePtr, newImagePtr, 
+                                      &fullRegion);
+}
+
+/*******************************************************************************
+* Function Name:  void Pv_EINK_PartialStageRegionHandler(pv_eink_frame_data_t* 
+*                       previousImagePtr, pv_eink_frame_data_t* newImagePtr,
+*                       pv_eink_region_t const* region)
+********************************************************************************
+*
+* Summary: Performs the partial update driving stage on a region of the display.
+*
+* Only the lines of the region that differ between the two images are driven; 
+* an unchanged line would carry "nothing" pixels only. The pixels left and right
+* of the region are sent as "nothing" pixels. Each driven line is sent with its
+* scan byte and then once more without it. Only the first pass carries the scan 
+* bytes; the repeat passes send the data lines with the scan bytes cleared, as
+* the prepared frame used to be cleared in place.
+*
+* The repeat passes keep the cadence of a whole-frame pass: after the changed 
+* lines have been sent, the task sleeps for the time the unchanged lines would
+* have taken, so the changed lines see the same drive timing while the SPI 
+* traffic scales with the number of changed lines.
+*
+* Parameters:
+* pv_eink_frame_data_t* previousImagePtr : The pointer of memory that contains 
+*                                    previous frame written to the E-INK display
+* pv_eink_frame_data_t* newImagePtr      : The pointer of memory that contains a 
+*                       new frame which needs to be written to the E-INK display
+* pv_eink_region_t const* region         : Lines and bytes of the frame to drive
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  This is a blocking function that can take 1 to 2 seconds. The data lines are
+*  streamed by the SPI interrupt, so the calling task sleeps for most of it.
+*  Returns at once if the region is identical in the two images.
+*******************************************************************************/
+void Pv_EINK_PartialStageRegionHandler(pv_eink_frame_data_t* previousImagePtr, 
+                                       pv_eink_frame_data_t* newImagePtr,
+                                       pv_eink_region_t const* region)
+{
     /* Counter variable for the vertical pixel loop */
     uint16_t    y;
-    /* Counter variable for the horizontal byte loop */
-    uint16_t    k;
     
-    /* Temporary storage for image data bytes */
-    uint8_t     oldByte;
-    /* Temporary storage for image data bytes */
-    uint8_t     newByte;
+    /* Pointers to the line buffers being prepared */
+    driver_data_packet_t* packet;
+    driver_data_packet_t* unscannedPacket;
     
-    /* Variable for storing the line number under scan */
-    int16       scanlineNumber = 0;
+    /* Offset of the current line in the image data */
+    uint16_t    lineOffset;
+    
+    /* Number of lines that changed */
+    uint16_t    dirtyCount;
+    
+    /* Flag that indicates a region narrower than the display */
+    bool        maskLine = (region->firstByte != 0u) || 
+                           (region->lastByte != (PV_EINK_HORIZONTAL_SIZE - 1u));
+    
+    /* E-INK timer tick at the start of a pass */
+    uint32_t    passStart;
+    
+    /* Flag that indicates the first pass of the stage */
+    bool        firstPass = true;
+    
+    PV_EINK_BENCH_STAGE_START;
+    
+    dirtyCount = Pv_EINK_FindDirtyRows(previousImagePtr, newImagePtr, region);
     
     /* Re-initialize E-INK timer to ensure the same duration of each stage  */
     Cy_EINK_TimerInit();
     
-    /* Vcom level adjust */
-    Pv_EINK_SendByte(PV_EINK_VCOM2_LEVEL_COMMAND_INDEX,
-                     PV_EINK_VCOM2_LEVEL_COMMAND_DATA);
-     
-    /* Vertical pixel loop */
-    for (y = 0; y < PV_EINK_VERTICAL_SIZE; y++)
+    /* Nothing to drive if no line has changed; the stage still ends below */
+    if (dirtyCount != 0u)
     {
-        /* Clear the line buffer with all zeros */
-        memset(&bulkDriverPacket[y].lineBuffer, 0, 
-               sizeof(bulkDriverPacket[y].lineBuffer)) ;
-
-        /* Initialize the even data, odd data and scan data pointers */
-        dataLineEven = &bulkDriverPacket[y].lineDataBySize.even[0];
-        dataLineOdd  = &bulkDriverPacket[y].lineDataBySize.odd[0];
-        dataLineScan = &bulkDriverPacket[y].lineDataBySize.scan[0];
-
-        /* Horizontal bytes initialization */
-        k = PV_EINK_HORIZONTAL_SIZE;
-        k--;
+        /* Vcom level adjust */
+        Pv_EINK_SendByte(PV_EINK_VCOM2_LEVEL_COMMAND_INDEX,
+                         PV_EINK_VCOM2_LEVEL_COMMAND_DATA);
         
-        /* Horizontal pixel loop */
-        for (x = 0; x < PV_EINK_HORIZONTAL_SIZE; x++)
+        /* Perform the update operation until the total time of frames 
+           exceed stage time */
+        do
         {
-            /* Fetch successive data bytes */
-            oldByte = *previousImagePtr++;
-            newByte = *newImagePtr++;
+            passStart = Cy_EINK_GetTimeTick();
+            PV_EINK_BENCH_PASS;
             
-            /* Calculate the Even and Odd bytes for partial update stage. Also, 
-               if the new data byte is same as the previous data byte, store a 
-               "nothing" pixel, so that the E-INK pixel won't be altered.
-               If the new data byte is different from the previous data byte, 
-               store the new data byte */
-            dataLineOdd[x]       = ((oldByte ^ newByte) & PV_EINK_ODD_MASK_A)
-                                    ?((newByte & PV_EINK_ODD_MASK_A)
-                                    ? PV_EINK_WHITE3
-                                    : PV_EINK_BLACK3) : PV_EINK_NOTHING3;
-            dataLineOdd[x]      |= ((oldByte ^ newByte) & PV_EINK_ODD_MASK_B)
-                                    ?((newByte & PV_EINK_ODD_MASK_B) 
-                                    ? PV_EINK_WHITE2 
-                                    : PV_EINK_BLACK2) : PV_EINK_NOTHING2;
-            dataLineOdd[x]      |= ((oldByte ^ newByte) & PV_EINK_ODD_MASK_C)
-                                    ?((newByte & PV_EINK_ODD_MASK_C) 
-                                    ? PV_EINK_WHITE1
-                                    : PV_EINK_BLACK1) : PV_EINK_NOTHING1;
-            dataLineOdd[x]      |= ((oldByte ^ newByte) & PV_EINK_ODD_MASK_D)
-                                    ?((newByte & PV_EINK_ODD_MASK_D) 
-                                    ? PV_EINK_WHITE0 
-                                    : PV_EINK_BLACK0) : PV_EINK_NOTHING0;
-            dataLineEven[k]      = ((oldByte ^ newByte) & PV_EINK_EVEN_MASK_A)
-                                    ?((newByte & PV_EINK_EVEN_MASK_A) 
-                                    ? PV_EINK_WHITE0
-                                    : PV_EINK_BLACK0) : PV_EINK_NOTHING0;
-            dataLineEven[k]     |= ((oldByte ^ newByte) & PV_EINK_EVEN_MASK_B) 
-                                    ?((newByte & PV_EINK_EVEN_MASK_B) 
-                                    ? PV_EINK_WHITE1
-                                    : PV_EINK_BLACK1) : PV_EINK_NOTHING1;
-            dataLineEven[k]     |= ((oldByte ^ newByte) & PV_EINK_EVEN_MASK_C)
-                                    ?((newByte & PV_EINK_EVEN_MASK_C) 
-                                    ? PV_EINK_WHITE2 
-                                    : PV_EINK_BLACK2) : PV_EINK_NOTHING2;
-            dataLineEven[k--]   |= ((oldByte ^ newByte) & PV_EINK_EVEN_MASK_D)
-                                    ?((newByte & PV_EINK_EVEN_MASK_D) 
-                                    ? PV_EINK_WHITE3 
-                                    : PV_EINK_BLACK3) : PV_EINK_NOTHING3;
-        }
-        /* Move onto the next line */
-        scanlineNumber = PV_EINK_VERTICAL_SIZE - y;
-        scanlineNumber--;
-        
-        /* Shift Scan byte according to the data line */
-        dataLineScan[(scanlineNumber >> PV_EINK_PIXEL_SIZE)] = scanTable
-                            [(scanlineNumber % PV_EINK_SCAN_TABLE_SIZE)];
-    }
-    
-    /* Perform the update operation until the total time of frames exceed stage
-       time */
-    do
-    {
-        /* Perform a line by line update */
-        for (y = 0; y < PV_EINK_VERTICAL_SIZE; y++)
-        {
-            /* Send the prepared data to the E-INK display */
-            Pv_EINK_SendData(PV_EINK_PIXEL_DATA_COMMAND_INDEX,
-                            (uint8_t*) &bulkDriverPacket[y].lineBuffer,
-                             PV_EINK_DATA_LINE_SIZE);
-            /* Turn on Output Enable to latch the frame */
-            Pv_EINK_SendByte(PV_EINK_ENABLE_OE_COMMAND_INDEX,
-                             PV_EINK_ENABLE_OE_COMMAND_DATA);
+            /* Perform a line by line update of the changed lines */
+            for (y = region->firstLine; y <= region->lastLine; y++)
+            {
+                if ((dirtyRows[y >> 3u] & (uint8_t)(1u << (y & 7u))) == 0u)
+                {
+                    continue;
+                }
+                
+                lineOffset = y * PV_EINK_HORIZONTAL_SIZE;
+                
+                /* Encode the line into the next free buffer of the ring */
+                packet = Pv_EINK_NextLinePacket();
+                PV_EINK_BENCH_ENCODE_START;
+                Pv_EINK_EncodePartialLine(packet, &previousImagePtr[lineOffset],
+                                          &newImagePtr[lineOffset]);
+                if (maskLine)
+                {
+                    Pv_EINK_MaskLine(packet, region);
+                }
+                if (firstPass)
+                {
+                    Pv_EINK_SetScanByte(packet, y);
+                }
+                PV_EINK_BENCH_ENCODE_END(1u);
+                
+                /* Queue the prepared data and the latch for the E-INK 
+                   display */
+                Pv_EINK_StreamLine((uint8_t*) &packet->lineBuffer);
+                
+                /* Re-send the line with the scan line re-initialized (extra 
+                   step for partial update) */
+                unscannedPacket = Pv_EINK_NextLinePacket();
+                PV_EINK_BENCH_ENCODE_START;
+                memcpy(&unscannedPacket->lineBuffer, &packet->lineBuffer,
+                       sizeof(packet->lineBuffer));
+                memset(&unscannedPacket->lineDataBySize.scan, 
+                       PV_EINK_SCAN_BYTE_INIT,
+                       sizeof(unscannedPacket->lineDataBySize.scan));
+                PV_EINK_BENCH_ENCODE_END(1u);
+
+                Pv_EINK_StreamLine((uint8_t*) &unscannedPacket->lineBuffer);
+            }
             
-            /* Calculate the current line under scan */
-            scanlineNumber = PV_EINK_VERTICAL_SIZE - y;
-            scanlineNumber--;
+            /* Sleep for the time of the unchanged lines */
+            Pv_EINK_WaitPassEnd(passStart, dirtyCount, partialUpdateTime);
             
-            /* Re-initialize the scan line (extra step for partial update) */
-            bulkDriverPacket[y].lineDataBySize.scan[(scanlineNumber 
-                                                     >> PV_EINK_PIXEL_SIZE)]
-                                                     = PV_EINK_SCAN_BYTE_INIT;
-
-            Pv_EINK_SendData(PV_EINK_PIXEL_DATA_COMMAND_INDEX,
-                            (uint8_t*) &bulkDriverPacket[y].lineBuffer,
-                             PV_EINK_DATA_LINE_SIZE);
-            Pv_EINK_SendByte(PV_EINK_ENABLE_OE_COMMAND_INDEX,
-                             PV_EINK_ENABLE_OE_COMMAND_DATA);
+            firstPass = false;
         }
+        /* Loop until the total time of frames exceed stage time */
+        while (partialUpdateTime > Cy_EINK_GetTimeTick());
     }
-    /* Loop until the total time of frames exceed stage time */
-    while (partialUpdateTime > Cy_EINK_GetTimeTick());
+    PV_EINK_BENCH_STAGE_END;
     
     /* Stop system timer */
     Cy_EINK_TimerStop();
     
     /* Re-adjust Vcom level */
-    Pv_EINK_SendByte(PV_EINK_VCOM1_LEVEL_COMMAND_INDEX, 
-                     PV_EINK_VCOM1_LEVEL_COMMAND_DATA);
+    if (dirtyCount != 0u)
+    {
+        Pv_EINK_SendByte(PV_EINK_VCOM1_LEVEL_COMMAND_INDEX, 
+                         PV_EINK_VCOM1_LEVEL_COMMAND_DATA);
+    }
 }
 
 /*******************************************************************************
@@ -864,6 +1432,12 @@ void Pv_EINK_NothingFrame(void)
     /* Counter variable for data line bytes */
     uint16_t    byteCounter;
     
+    /* The frame is prepared in the single line buffer; the data pointers may
+       still point into the line ring after a display update */
+    dataLineEven = &driverPacket.lineDataBySize.even[0];
+    dataLineOdd  = &driverPacket.lineDataBySize.odd[0];
+    dataLineScan = &driverPacket.lineDataBySize.scan[0];
+    
     /* Set all Even and Odd data bytes as "Nothing" bytes */
     for (byteCounter = 0; byteCounter < PV_EINK_HORIZONTAL_SIZE; byteCounter++)
     {
@@ -908,16 +1482,10 @@ void Pv_EINK_NothingFrame(void)
 *******************************************************************************/
 void Pv_EINK_DummyLine(void)
 {
-    /* Counter variable for data line bytes */
-    uint8_t byteCounter;
-    
-    /* Create a data line containing dummy bytes */
-    for (byteCounter = 0; byteCounter < (PV_EINK_VERTICAL_SIZE 
-                                        / CY_EINK_BYTE_SIZE);
-         byteCounter++)
-    {
-        driverPacket.lineBuffer[byteCounter] = PV_EINK_DUMMY_BYTE;
-    }
+    /* Create a data line containing dummy bytes. The line buffer holds the
+       "Nothing" bytes of the preceding "Nothing Frame" */
+    memset(&driverPacket.lineBuffer, PV_EINK_DUMMY_BYTE,
+           sizeof(driverPacket.lineBuffer));
     
     /* Set charge pump voltage level to reduce voltage shift */
     Pv_EINK_SendByte(PV_EINK_PWR2_SETTING_COMMAND_INDEX, 
@@ -949,6 +1517,13 @@ void Pv_EINK_DummyLine(void)
 *******************************************************************************/
 pv_eink_status_t Pv_EINK_HardwarePowerOn(void)
 {
+    /* The update timing needs the E-INK timer; do not drive the display 
+    without it */
+    if (!Cy_EINK_StartTimer())
+    {
+        return(PV_EINK_ERROR_TIMER);
+    }
+    
     /* Enable the load switch connected to E-INK display's Vcc, and wait till
     the voltage ramps up to the level required for proper operation of E-INK */
     CY_EINK_TurnOnVcc;
@@ -968,6 +1543,9 @@ pv_eink_status_t Pv_EINK_HardwarePowerOn(void)
     CY_EINK_RstHigh;
     CY_EINK_Delay(PV_EINK_PIN_DELAY);
     
+    /* Start with a working SPI queue */
+    spiStatus = PV_EINK_RES_OK;
+    
     /* Initialize E-INK Driver */
     return(Pv_EINK_InitDriver());
 }
@@ -983,7 +1561,8 @@ pv_eink_status_t Pv_EINK_HardwarePowerOn(void)
 *  None
 *
 * Return:
-*  pv_eink_status_t : Status of the power off operation
+*  pv_eink_status_t : Status of the power off operation, PV_EINK_ERROR_SPI if
+*                     lines of the updates were lost
 *
 * Side Effects:
 *  None
@@ -1049,7 +1628,99 @@ pv_eink_status_t Pv_EINK_HardwarePowerOff(void)
     CY_EINK_DischargeLow;
     
     /* If all operations were completed successfully, send the corresponding flag */
-    return(PV_EINK_RES_OK);
+    return(spiStatus);
+}
+
+#ifdef CY_EINK_BENCHMARK
+/*******************************************************************************
+* Function Name: static void Pv_EINK_BenchEncodeEnd(uint16_t lines)
+********************************************************************************
+*
+* Summary: Adds the cycles since PV_EINK_BENCH_ENCODE_START to the stage in
+* progress.
+*
+* Parameters:
+*  uint16_t lines : Number of data lines prepared
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static void Pv_EINK_BenchEncodeEnd(uint16_t lines)
+{
+    benchStage.encodeCycles += Cy_EINK_GetCycleCount() - benchEncodeStart;
+    benchStage.lineCount += lines;
+}
+
+/*******************************************************************************
+* Function Name: static void Pv_EINK_BenchStageEnd(void)
+********************************************************************************
+*
+* Summary: Records the cost of the stage in progress. Stages beyond 
+* PV_EINK_BENCH_MAX_STAGES are not recorded.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+static void Pv_EINK_BenchStageEnd(void)
+{
+    benchStage.stageTime = Cy_EINK_GetTimeTick();
+    if (benchStageCount < PV_EINK_BENCH_MAX_STAGES)
+    {
+        benchStages[benchStageCount++] = benchStage;
+    }
+}
+
+/*******************************************************************************
+* Function Name: void Pv_EINK_BenchReset(void)
+********************************************************************************
+*
+* Summary: Clears the recorded stage costs.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+void Pv_EINK_BenchReset(void)
+{
+    benchStageCount = 0u;
+}
+
+/*******************************************************************************
+* Function Name: uint8_t Pv_EINK_BenchStages(pv_eink_bench_stage_t const** 
+*                                            stages)
+********************************************************************************
+*
+* Summary: Returns the stage costs recorded since the last Pv_EINK_BenchReset().
+*
+* Parameters:
+*  pv_eink_bench_stage_t const** stages : Set to the recorded stages, in the 
+*                                         order they ran
+*
+* Return:
+*  uint8_t : Number of recorded stages
+*
+* Side Effects:
+*  None
+*******************************************************************************/
+uint8_t Pv_EINK_BenchStages(pv_eink_bench_stage_t const** stages)
+{
+    *stages = benchStages;
+    return(benchStageCount);
 }
+#endif /* CY_EINK_BENCHMARK */
 
 /* [] END OF FILE */
@@ -61,7 +61,9 @@ typedef enum
     PV_EINK_ERROR_ID,
     PV_EINK_ERROR_BREAKAGE,
     PV_EINK_ERROR_DC,
-    PV_EINK_ERROR_CHARGEPUMP
+    PV_EINK_ERROR_CHARGEPUMP,
+    PV_EINK_ERROR_SPI,
+    PV_EINK_ERROR_TIMER
 }   pv_eink_status_t;
 
 /* Data-type of E-INK update stages */
@@ -73,9 +75,37 @@ typedef enum
     PV_EINK_STAGE4
 }   pv_eink_stage_t ;
 
+/* Data-type of a display region. The bytes are the image bytes of a line and 
+   the limits are inclusive */
+typedef struct
+{
+    uint8_t firstByte;
+    uint8_t lastByte;
+    uint8_t firstLine;
+    uint8_t lastLine;
+}   pv_eink_region_t;
+
+#ifdef CY_EINK_BENCHMARK
+/* Maximum number of stages of an update recorded by the benchmark */
+#define PV_EINK_BENCH_MAX_STAGES    (uint8_t)(4u)
+
+/* Data-type of the cost of an update stage, recorded by the benchmark build */
+typedef struct
+{
+    /* CPU cycles spent preparing the data lines */
+    uint32_t    encodeCycles;
+    /* E-INK timer ticks (uS) of the stage */
+    uint32_t    stageTime;
+    /* Number of passes over the lines of the stage */
+    uint16_t    passCount;
+    /* Number of data lines sent */
+    uint16_t    lineCount;
+}   pv_eink_bench_stage_t;
+#endif /* CY_EINK_BENCHMARK */
+
 /* Declarations of functions defined in pv_eink_hardware_driver.c */
 /* Power control and initialization functions */
-void                Pv_EINK_Init(void);
+pv_eink_status_t    Pv_EINK_Init(void);
 pv_eink_status_t    Pv_EINK_HardwarePowerOn(void);
 pv_eink_status_t    Pv_EINK_HardwarePowerOff(void);
 
@@ -86,7 +116,19 @@ void    Pv_EINK_SetTempFactor(int8_t temperature);
 void    Pv_EINK_FullStageHandler(pv_eink_frame_data_t* imagePtr, pv_eink_stage_t stageNumber);
 void    Pv_EINK_PartialStageHandler(pv_eink_frame_data_t* previousImagePtr, 
                                     pv_eink_frame_data_t* newImagePtr);
+void    Pv_EINK_FullStageRegionHandler(pv_eink_frame_data_t* imagePtr, 
+                                       pv_eink_stage_t stageNumber,
+                                       pv_eink_region_t const* region);
+void    Pv_EINK_PartialStageRegionHandler(pv_eink_frame_data_t* previousImagePtr, 
+                                          pv_eink_frame_data_t* newImagePtr,
+                                          pv_eink_region_t const* region);
 int Cy_EINK_WriteSPIBuffer(uint8_t* data, uint16 dataLength);
 
+#ifdef CY_EINK_BENCHMARK
+/* Stage costs of the updates since the last Pv_EINK_BenchReset() */
+void    Pv_EINK_BenchReset(void);
+uint8_t Pv_EINK_BenchStages(pv_eink_bench_stage_t const** stages);
+#endif /* CY_EINK_BENCHMARK */
+
 #endif  /* PERVASIVE_EINK_HARDWARE_DRIVER_H */
 /* [] END OF FILE */
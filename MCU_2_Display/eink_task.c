@@ -1,88 +1,426 @@
 #include "eink_task.h"
 
+#include <stdio.h>
+#include <string.h>
+
 #include "cyhal.h"
 #include "cybsp.h"
 #include "GUI.h"
 #include "pervasive_eink_hardware_driver.h"
 #include "cy_eink_library.h"
+#include "cy_eink_update_policy.h"
+#include "cy_eink_power_session.h"
+#include "cy_eink_benchmark.h"
 #include "LCDConf.h"
 #include "FreeRTOS.h"
 #include "task.h"
 
 #include "main_fsm.h"
 #include "cfg.h"
+#include "flash_counter.h"
+
+/* Ambient temperature assumed for the display until a temperature has been
+   measured, in degree Celsius */
+#define EINK_AMBIENT_TEMPERATURE    (20)
+
+/* True once the shown plane of the emWin display buffers holds the frame shown
+   on the display */
+static bool shownFrameValid = false;
+
+/* True while the emWin display buffer holds the title and the labels of the
+   booking screen, so that only the field values have to be redrawn */
+static bool bookingLayoutDrawn = false;
+
+/* Position of the lines of the booking screen */
+#define BOOKING_TITLE_Y     (5)
+#define BOOKING_TEXT_X      (5)
+
+/* Fields of the booking screen */
+typedef enum {
+    BOOKING_FIELD_DURATION,
+    BOOKING_FIELD_OWNER,
+    BOOKING_FIELD_STATUS,
+    BOOKING_FIELD_COUNT
+} booking_field_t;
+
+/* Labels and lines of the fields */
+static const char * const booking_labels[BOOKING_FIELD_COUNT] = {
+    "Duration: ", "Booked by: ", "Status: "
+};
+static const int booking_field_y[BOOKING_FIELD_COUNT] = {53, 73, 93};
+
+/* Booking screen with the title and the labels only, rendered once, and the
+   rectangles reserved for the field values */
+static uint8_t booking_template[CY_EINK_FRAME_SIZE];
+static bool booking_template_valid = false;
+static GUI_RECT booking_value_rect[BOOKING_FIELD_COUNT];
+
+/* Members of BookingInfo that differ between two bookings */
+#define BOOKING_CHANGE_START_TIME   (0x01u)
+#define BOOKING_CHANGE_END_TIME     (0x02u)
+#define BOOKING_CHANGE_OWNER_NAME   (0x04u)
+#define BOOKING_CHANGE_STATUS       (0x08u)
+#define BOOKING_CHANGE_ALL          (0x0Fu)
+
+/* Members shown by each field of the booking screen */
+static const uint8_t booking_field_changes[BOOKING_FIELD_COUNT] = {
+    BOOKING_CHANGE_START_TIME | BOOKING_CHANGE_END_TIME,
+    BOOKING_CHANGE_OWNER_NAME,
+    BOOKING_CHANGE_STATUS
+};
+
+/* Booking shown on the display. It is kept in the serial flash as well, so
+   that it survives hibernate, where the display keeps its image but the RAM
+   is lost */
+typedef struct {
+    uint32_t magic;
+    BookingInfo info;
+} booking_snapshot_t;
+
+#define BOOKING_SNAPSHOT_MAGIC      (0x424B4E47u)
+
+static BookingInfo shown_booking;
+static bool shown_booking_valid = false;
+
+/* Number of display updates skipped because the frame did not change */
+uint32_t skipped_display_updates = 0;
+
+/* Latest temperatures measured by the BLE radio die sensor and by the room 
+   node, in degree Celsius */
+static volatile int8_t die_temperature;
+static volatile bool die_temperature_valid = false;
+static volatile int8_t room_temperature;
+static volatile bool room_temperature_valid = false;
+
+static int8_t clamp_temperature(int16_t temperature)
+{
+    if(temperature > INT8_MAX) {
+        return INT8_MAX;
+    }
+    if(temperature < INT8_MIN) {
+        return INT8_MIN;
+    }
+    return (int8_t) temperature;
+}
+
+void eink_set_die_temperature(int16_t temperature)
+{
+    die_temperature = clamp_temperature(temperature);
+    die_temperature_valid = true;
+}
 
-/* Display frame buffer cache */
-uint8 imageBufferCache[PV_EINK_IMAGE_SIZE] = {0};
+void eink_set_room_temperature(int16_t temperature)
+{
+    room_temperature = clamp_temperature(temperature);
+    room_temperature_valid = true;
+}
 
-void UpdateDisplay(cy_eink_update_t updateMethod, bool powerCycle)
+/* Recompute the stage timing and the update policy from the best temperature
+   available: the room temperature, else the die temperature, else the default */
+static void apply_display_temperature(void)
 {
-    cy_eink_frame_t* pEmwinBuffer;
+    int8_t temperature = EINK_AMBIENT_TEMPERATURE;
 
-    /* Get the pointer to Emwin's display buffer */
+    if(room_temperature_valid) {
+        temperature = room_temperature;
+    } else if(die_temperature_valid) {
+        temperature = die_temperature;
+    }
+
+    Pv_EINK_SetTempFactor(temperature);
+    Cy_EINK_PolicySetTemperature(temperature);
+}
+
+/* Show the emWin display buffer on the display. Returns false if the display
+   could not be powered, in which case it still shows the previous frame */
+bool UpdateDisplay(cy_eink_update_t updateMethod)
+{
+    cy_eink_frame_t* pEmwinBuffer;
+    cy_eink_frame_t* pShownBuffer;
+    LCD_RECT dirtyRect;
+    cy_eink_rect_t updateRect;
+    bool drawn;
+    uint16_t firstByte;
+    uint16_t byteCount;
+
+    /* Get the pointers to Emwin's display buffer and to the frame shown on
+       the display */
     pEmwinBuffer = (cy_eink_frame_t*)LCD_GetDisplayBuffer();
+    pShownBuffer = (cy_eink_frame_t*)LCD_GetShownBuffer();
+
+    /* The two frames can only differ where emWin has drawn since the last
+       update */
+    drawn = (LCD_GetDirtyRect(&dirtyRect) != 0);
+    if (drawn) {
+        updateRect.x1 = (dirtyRect.x0 < 0) ? 0u : (uint16_t)dirtyRect.x0;
+        updateRect.y1 = (dirtyRect.y0 < 0) ? 0u : (uint16_t)dirtyRect.y0;
+        updateRect.x2 = (dirtyRect.x1 >= CY_EINK_WIDTH) ?
+                        (CY_EINK_WIDTH - 1u) : (uint16_t)dirtyRect.x1;
+        updateRect.y2 = (dirtyRect.y1 >= CY_EINK_HEIGHT) ?
+                        (CY_EINK_HEIGHT - 1u) : (uint16_t)dirtyRect.y1;
+        drawn = (updateRect.x1 <= updateRect.x2) && (updateRect.y1 <= updateRect.y2);
+    }
 
-    /* Update the EInk display */
-    Cy_EINK_ShowFrame(imageBufferCache, pEmwinBuffer, updateMethod, powerCycle);
+    /* Nothing to do if the display already shows this frame: nothing was 
+       drawn, or the drawn lines did not change. memcmp compares whole words
+       on aligned buffers, so this costs far less than powering the panel */
+    if (shownFrameValid) {
+        firstByte = drawn ? (updateRect.y1 * PV_EINK_HORIZONTAL_SIZE) : 0u;
+        byteCount = drawn ? ((updateRect.y2 - updateRect.y1 + 1u) * 
+                             PV_EINK_HORIZONTAL_SIZE) : 0u;
+        if (memcmp(&pShownBuffer[firstByte], &pEmwinBuffer[firstByte], 
+                   byteCount) == 0)
+        {
+            skipped_display_updates++;
+            return true;
+        }
+    }
+
+    /* The whole display is refreshed when the frame it shows is unknown */
+    if (!shownFrameValid) {
+        updateMethod = CY_EINK_FULL_4STAGE;
+    }
 
-    /* Copy the EmWin display buffer to the imageBuffer cache*/
-    memcpy(imageBufferCache, pEmwinBuffer, CY_EINK_FRAME_SIZE);
+    /* Update the EInk display. A partial update only drives the drawn area.
+       The display stays powered until the power session has been idle for 
+       its timeout */
+    if (!Cy_EINK_SessionAcquire()) {
+        /* Nothing was driven. Forget the shown frame, so that the next update
+           retries with a full refresh */
+        Cy_EINK_SessionRelease();
+        shownFrameValid = false;
+        return false;
+    }
+    if (shownFrameValid && (updateMethod == CY_EINK_PARTIAL)) {
+        Cy_EINK_ShowRegion(pShownBuffer, pEmwinBuffer, &updateRect,
+                           updateMethod, false);
+    } else {
+        Cy_EINK_ShowFrame(pShownBuffer, pEmwinBuffer, updateMethod, false);
+    }
+    Cy_EINK_SessionRelease();
+    Cy_EINK_PolicyRecord(updateMethod);
+
+    /* The display buffer is now the shown frame; emWin draws the next screen
+       on top of it in the other plane */
+    LCD_SwapDisplayBuffers();
+    shownFrameValid = true;
+    return true;
 }
 
 
-void show_booking_info(BookingInfo info) {
-    /* Set font size, foreground and background colors */
-    GUI_SetColor(GUI_BLACK);
-    GUI_SetBkColor(GUI_WHITE);
-    GUI_SetTextMode(GUI_TM_NORMAL);
-    GUI_SetTextStyle(GUI_TS_NORMAL);
+/* Render the title and the field labels of the booking screen into the
+   display buffer and keep a copy of it as the template of the screen */
+static void render_booking_template(void)
+{
+    uint8_t field;
 
-    /* Clear the screen */
     GUI_Clear();
 
     /* Display page title */
     GUI_SetFont(GUI_FONT_20B_1);
     GUI_SetTextAlign(GUI_TA_HCENTER);
+    GUI_DispStringAt("Room booking status", 132, BOOKING_TITLE_Y);
+
+    /* Display the labels and reserve the rest of their line for the value */
+    GUI_SetFont(GUI_FONT_16B_1);
+    GUI_SetTextAlign(GUI_TA_LEFT);
+    for(field = 0; field < BOOKING_FIELD_COUNT; field++) {
+        GUI_DispStringAt(booking_labels[field], BOOKING_TEXT_X,
+                         booking_field_y[field]);
+
+        booking_value_rect[field].x0 = BOOKING_TEXT_X +
+                                       GUI_GetStringDistX(booking_labels[field]);
+        booking_value_rect[field].y0 = booking_field_y[field];
+        booking_value_rect[field].x1 = LCD_GetXSize() - 1;
+        booking_value_rect[field].y1 = booking_field_y[field] +
+                                       GUI_GetFontSizeY() - 1;
+    }
 
-    GUI_DispStringAt("Room booking status", 132, 5);
+    memcpy(booking_template, LCD_GetDisplayBuffer(), CY_EINK_FRAME_SIZE);
+    booking_template_valid = true;
+}
 
-	static char occupation_duration_line[24] = "Duration: ";
+/* Start the booking screen from its template, rendering the template on
+   first use */
+static void draw_booking_layout(void)
+{
+    if(!booking_template_valid) {
+        render_booking_template();
+        return;
+    }
 
-    struct tm *timeinfo = localtime(&info.start_time);
-    sprintf(occupation_duration_line + 10,
-    		"%02d:%02d - ",
-			timeinfo->tm_hour, timeinfo->tm_min);
+    memcpy(LCD_GetDisplayBuffer(), booking_template, CY_EINK_FRAME_SIZE);
+    LCD_AddDirtyRect(0, 0, LCD_GetXSize() - 1, LCD_GetYSize() - 1);
+}
 
-    timeinfo = localtime(&info.end_time);
-    sprintf(occupation_duration_line + 18,
-    		"%02d:%02d",
-			timeinfo->tm_hour, timeinfo->tm_min);
+/* Render the value of a field into its reserved rectangle */
+static void draw_booking_field(booking_field_t field, const char *value)
+{
+    GUI_ClearRectEx(&booking_value_rect[field]);
+    GUI_DispStringAt(value, booking_value_rect[field].x0,
+                     booking_value_rect[field].y0);
+}
 
-    occupation_duration_line[35] = '\0';
+/* Render the fields that show one of the changed members of the booking */
+static void draw_booking_fields(const BookingInfo *info, uint8_t changes)
+{
+    static char duration_value[16];
+    struct tm start;
+    struct tm end;
 
     GUI_SetFont(GUI_FONT_16B_1);
-    GUI_DispStringAt(occupation_duration_line, 5, 53);
+    GUI_SetTextAlign(GUI_TA_LEFT);
+
+    if((changes & booking_field_changes[BOOKING_FIELD_DURATION]) != 0u) {
+        start = *localtime(&info->start_time);
+        end = *localtime(&info->end_time);
+        snprintf(duration_value, sizeof(duration_value), "%02d:%02d - %02d:%02d",
+                 start.tm_hour, start.tm_min, end.tm_hour, end.tm_min);
+        draw_booking_field(BOOKING_FIELD_DURATION, duration_value);
+    }
 
-    GUI_DispStringAt("Booked by: ", 5, 73);
-    GUI_DispStringAt(info.owner_name, 5 + GUI_GetStringDistX("Booked by: "), 73);
+    if((changes & booking_field_changes[BOOKING_FIELD_OWNER]) != 0u) {
+        draw_booking_field(BOOKING_FIELD_OWNER, info->owner_name);
+    }
 
-    if(info.occupation_status) {
-		GUI_DispStringAt("Status: Occupied", 5, 93);
-    } else {
-		GUI_DispStringAt("Status: Free", 5, 93);
+    if((changes & booking_field_changes[BOOKING_FIELD_STATUS]) != 0u) {
+        draw_booking_field(BOOKING_FIELD_STATUS,
+                           info->occupation_status ? "Occupied" : "Free");
+    }
+}
+
+/* Compare two bookings member by member and return the changed members */
+static uint8_t compare_booking_info(const BookingInfo *old_info,
+                                    const BookingInfo *new_info)
+{
+    uint8_t changes = 0u;
+
+    if(old_info->start_time != new_info->start_time) {
+        changes |= BOOKING_CHANGE_START_TIME;
+    }
+    if(old_info->end_time != new_info->end_time) {
+        changes |= BOOKING_CHANGE_END_TIME;
+    }
+    if((old_info->owner_name_len != new_info->owner_name_len) ||
+       (memcmp(old_info->owner_name, new_info->owner_name,
+               new_info->owner_name_len) != 0)) {
+        changes |= BOOKING_CHANGE_OWNER_NAME;
     }
+    if(old_info->occupation_status != new_info->occupation_status) {
+        changes |= BOOKING_CHANGE_STATUS;
+    }
+
+    return changes;
+}
 
-    /* Send the display buffer data to display*/
-    UpdateDisplay(CY_EINK_FULL_4STAGE, true);
+#if(LOW_POWER_MODE == LOW_POWER_HIBERNATE)
+/* Read the booking shown on the display before the last hibernate */
+static void load_booking_snapshot(void)
+{
+    static booking_snapshot_t snapshot;
+
+    if(get_flash_data(BOOKING_SNAPSHOT_LOCATION, (uint8_t*)&snapshot,
+                      sizeof(snapshot)) &&
+       (snapshot.magic == BOOKING_SNAPSHOT_MAGIC)) {
+        shown_booking = snapshot.info;
+        shown_booking_valid = true;
+    }
+}
+
+/* Keep the booking shown on the display across hibernate. The sector is only
+   erased and written when the stored booking differs */
+void save_booking_snapshot(void)
+{
+    static booking_snapshot_t snapshot;
+    uint32_t magic = shown_booking_valid ? BOOKING_SNAPSHOT_MAGIC : 0u;
+
+    if(get_flash_data(BOOKING_SNAPSHOT_LOCATION, (uint8_t*)&snapshot,
+                      sizeof(snapshot)) &&
+       (snapshot.magic == magic) &&
+       (!shown_booking_valid ||
+        (compare_booking_info(&snapshot.info, &shown_booking) == 0u))) {
+        return;
+    }
+
+    snapshot.magic = magic;
+    snapshot.info = shown_booking;
+    set_flash_data(BOOKING_SNAPSHOT_LOCATION, (const uint8_t*)&snapshot,
+                   sizeof(snapshot));
+}
+#endif
+
+/* Rebuild the frame shown on the display from the booking it shows, after
+   the RAM has been lost in hibernate */
+static void restore_booking_screen(void)
+{
+    draw_booking_layout();
+    bookingLayoutDrawn = true;
+    draw_booking_fields(&shown_booking, BOOKING_CHANGE_ALL);
+
+    LCD_SwapDisplayBuffers();
+    shownFrameValid = true;
+}
+
+void show_booking_info(BookingInfo info) {
+    uint8_t changes = BOOKING_CHANGE_ALL;
+
+    /* Nothing to render nor to refresh if the display already shows this
+       booking */
+    if(shown_booking_valid) {
+        changes = compare_booking_info(&shown_booking, &info);
+        if(changes == 0u) {
+            skipped_display_updates++;
+            return;
+        }
+    }
+
+    /* Adjust the refresh to the current temperature */
+    apply_display_temperature();
+
+    /* Set font size, foreground and background colors */
+    GUI_SetColor(GUI_BLACK);
+    GUI_SetBkColor(GUI_WHITE);
+    GUI_SetTextMode(GUI_TM_NORMAL);
+    GUI_SetTextStyle(GUI_TS_NORMAL);
+
+    /* The display may still show a booking from before hibernate */
+    if(shown_booking_valid && !shownFrameValid) {
+        restore_booking_screen();
+    }
+
+    /* The title and the labels only have to be drawn after a clear */
+    if(!bookingLayoutDrawn) {
+        draw_booking_layout();
+        bookingLayoutDrawn = true;
+        changes = BOOKING_CHANGE_ALL;
+    }
+
+    /* Render the changed values only, into their reserved rectangles */
+    draw_booking_fields(&info, changes);
+
+    /* Send the display buffer data to display, with the update type that suits
+       the change */
+    if(!UpdateDisplay(Cy_EINK_PolicySelect((cy_eink_frame_t*)LCD_GetShownBuffer(),
+                          (cy_eink_frame_t*)LCD_GetDisplayBuffer()))) {
+        /* Draw the whole booking again at the next update */
+        shown_booking_valid = false;
+        return;
+    }
+
+    shown_booking = info;
+    shown_booking_valid = true;
 }
 
 
 void ClearScreen(void)
 {
+    apply_display_temperature();
     GUI_SetColor(GUI_BLACK);
     GUI_SetBkColor(GUI_WHITE);
     GUI_Clear();
-    UpdateDisplay(CY_EINK_FULL_4STAGE, true);
+    bookingLayoutDrawn = false;
+    UpdateDisplay(CY_EINK_FULL_4STAGE);
+    shown_booking_valid = false;
 }
 
 
@@ -96,10 +434,29 @@ void e_ink_init(void) {
     /* Initialize EmWin driver*/
     GUI_Init();
 
-    /* Start the eInk display interface and turn on the display power */
-	Cy_EINK_Start(20);
-	Pv_EINK_HardwarePowerOn();
+    /* Start the eInk display interface. The display is turned on by the power
+       session when the first frame is shown. Without the E-INK timer the
+       display cannot be powered, and every update reports the failure */
+	if(!Cy_EINK_Start(EINK_AMBIENT_TEMPERATURE)) {
+		printf("[INFO] : eInk timer could not be started \r\n");
+	}
+	Cy_EINK_SessionInit(CY_EINK_SESSION_IDLE_TIMEOUT, bleSemaphore);
+
+	/* Select the update type of each frame with the default thresholds */
+	Cy_EINK_PolicyInit(NULL);
+	Cy_EINK_PolicySetTemperature(EINK_AMBIENT_TEMPERATURE);
 
+#if(LOW_POWER_MODE == LOW_POWER_HIBERNATE)
+	/* After hibernate the display still shows the last booking */
+	if(Cy_SysLib_GetResetReason() == CY_SYSLIB_RESET_HIB_WAKEUP) {
+		load_booking_snapshot();
+	}
+#endif
+
+#ifdef CY_EINK_BENCHMARK
+	/* Print the cost of the update types on the debug UART */
+	Cy_EINK_BenchmarkRun(NULL);
+#endif
 }
 
 void e_ink_task(void*arg)
@@ -111,6 +468,12 @@ void e_ink_task(void*arg)
 		cyhal_gpio_write((cyhal_gpio_t)CYBSP_LED_RGB_GREEN, CYBSP_LED_STATE_ON);
 		xSemaphoreTake(bleSemaphore, portMAX_DELAY);
 
+		/* The power session gives the semaphore as well, to turn the display
+		   off once it has been idle */
+		if(Cy_EINK_SessionProcessIdle()) {
+			continue;
+		}
+
 		show_booking_info(booking_info);
 
 		cyhal_gpio_write((cyhal_gpio_t)CYBSP_LED_RGB_GREEN, CYBSP_LED_STATE_OFF);
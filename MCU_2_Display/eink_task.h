@@ -53,8 +53,18 @@ BookingInfo booking_info;
 SemaphoreHandle_t bleSemaphore;
 TaskHandle_t update_scr_task;
 
+/* Number of display updates skipped because the frame did not change */
+extern uint32_t skipped_display_updates;
+
 void e_ink_task(void*);
 
+/* Temperatures used to compensate the display refresh, in degree Celsius */
+void eink_set_die_temperature(int16_t temperature);
+void eink_set_room_temperature(int16_t temperature);
+
 void e_ink_init(void);
 
+/* Keep the booking shown on the display in the serial flash, before hibernate */
+void save_booking_snapshot(void);
+
 #endif /* EINK_TASK_H_ */
@@ -106,9 +106,18 @@ Purpose     : Display configuration file for GUIDRV_Bitplains to be
 **********************************************************************
 */
 //
-// Data arrays to be used by the display driver
+// Data arrays to be used by the display driver. The two planes swap roles
+// after each display update: emWin draws into one while the other holds the
+// frame shown on the display
 //
 static U8 _aPlain_0[BYTES_PER_LINE * YSIZE_PHYS];
+static U8 _aPlain_1[BYTES_PER_LINE * YSIZE_PHYS];
+
+//
+// Plane emWin draws into and plane shown on the display
+//
+static U8 * _pDrawPlane  = _aPlain_0;
+static U8 * _pShownPlane = _aPlain_1;
 
 //
 // Structure to be passed to the driver
@@ -119,6 +128,94 @@ static struct {
   _aPlain_0,
 }};
 
+//
+// Device API of the display driver and the copy of it that tracks the
+// drawn area before calling the driver
+//
+static const GUI_DEVICE_API * _pDriverAPI;
+static GUI_DEVICE_API         _TrackingAPI;
+
+//
+// Bounding rectangle of the pixels drawn since the last swap
+//
+static LCD_RECT _DirtyRect;
+static int      _IsDirty;
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+/*********************************************************************
+*
+*       _AddDirtyRect
+*
+* Purpose:
+*   Grows the dirty rectangle of the drawing plane to include the
+*   given rectangle.
+*/
+static void _AddDirtyRect(int x0, int y0, int x1, int y1)
+{
+  if (_IsDirty == 0)
+  {
+    _DirtyRect.x0 = (I16)x0;
+    _DirtyRect.y0 = (I16)y0;
+    _DirtyRect.x1 = (I16)x1;
+    _DirtyRect.y1 = (I16)y1;
+    _IsDirty      = 1;
+    return;
+  }
+  if (x0 < _DirtyRect.x0) { _DirtyRect.x0 = (I16)x0; }
+  if (y0 < _DirtyRect.y0) { _DirtyRect.y0 = (I16)y0; }
+  if (x1 > _DirtyRect.x1) { _DirtyRect.x1 = (I16)x1; }
+  if (y1 > _DirtyRect.y1) { _DirtyRect.y1 = (I16)y1; }
+}
+
+/*********************************************************************
+*
+*       Drawing functions of the tracking device API
+*
+* Purpose:
+*   Record the area each drawing operation touches, then let the
+*   display driver draw it.
+*/
+static void _DrawBitmap(GUI_DEVICE * pDevice, int x0, int y0, int xSize, int ySize, int BitsPerPixel, int BytesPerLine, const U8 * pData, int Diff, const LCD_PIXELINDEX * pTrans)
+{
+  _AddDirtyRect(x0, y0, x0 + xSize - 1, y0 + ySize - 1);
+  _pDriverAPI->pfDrawBitmap(pDevice, x0, y0, xSize, ySize, BitsPerPixel, BytesPerLine, pData, Diff, pTrans);
+}
+
+static void _DrawHLine(GUI_DEVICE * pDevice, int x0, int y, int x1)
+{
+  _AddDirtyRect(x0, y, x1, y);
+  _pDriverAPI->pfDrawHLine(pDevice, x0, y, x1);
+}
+
+static void _DrawVLine(GUI_DEVICE * pDevice, int x, int y0, int y1)
+{
+  _AddDirtyRect(x, y0, x, y1);
+  _pDriverAPI->pfDrawVLine(pDevice, x, y0, y1);
+}
+
+static void _FillRect(GUI_DEVICE * pDevice, int x0, int y0, int x1, int y1)
+{
+  _AddDirtyRect(x0, y0, x1, y1);
+  _pDriverAPI->pfFillRect(pDevice, x0, y0, x1, y1);
+}
+
+static void _SetPixelIndex(GUI_DEVICE * pDevice, int x, int y, LCD_PIXELINDEX ColorIndex)
+{
+  _AddDirtyRect(x, y, x, y);
+  _pDriverAPI->pfSetPixelIndex(pDevice, x, y, ColorIndex);
+}
+
+static void _XorPixel(GUI_DEVICE * pDevice, int x, int y)
+{
+  _AddDirtyRect(x, y, x, y);
+  _pDriverAPI->pfXorPixel(pDevice, x, y);
+}
+
 /*********************************************************************
 *
 *       Public code
@@ -139,9 +236,21 @@ void LCD_X_Config(void)
   GUI_DEVICE * pDevice;
   CONFIG_BITPLAINS Config = {0};
   //
+  // Wrap the drawing functions of the display driver to track the
+  // drawn area
+  //
+  _pDriverAPI                  = GUIDRV_BITPLAINS;
+  _TrackingAPI                 = *_pDriverAPI;
+  _TrackingAPI.pfDrawBitmap    = _DrawBitmap;
+  _TrackingAPI.pfDrawHLine     = _DrawHLine;
+  _TrackingAPI.pfDrawVLine     = _DrawVLine;
+  _TrackingAPI.pfFillRect      = _FillRect;
+  _TrackingAPI.pfSetPixelIndex = _SetPixelIndex;
+  _TrackingAPI.pfXorPixel      = _XorPixel;
+  //
   // Set display driver and color conversion for 1st layer
   //
-  pDevice = GUI_DEVICE_CreateAndLink(GUIDRV_BITPLAINS, COLOR_CONVERSION, 0, 0);
+  pDevice = GUI_DEVICE_CreateAndLink(&_TrackingAPI, COLOR_CONVERSION, 0, 0);
   /* Configure Bitplains library */
   Config.Mirror = 1;
   GUIDRV_BitPlains_Config(pDevice, &Config);
@@ -230,8 +339,117 @@ int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void * pData)
 U8* LCD_GetDisplayBuffer(void)
 {
   /* Return pointer to the display buffer */
-  return _aPlain_0;
+  return _pDrawPlane;
+}
+
+/*********************************************************************
+*
+*       LCD_GetShownBuffer
+*
+* Purpose:
+*   This function returns the pointer to the plane that holds the
+*   frame shown on the display, i.e. the display buffer of the last
+*   LCD_SwapDisplayBuffers()
+
+* Parameter:
+*   None
+*
+* Return Value:
+*   U8* - Pointer to the shown frame
+*/
+U8* LCD_GetShownBuffer(void)
+{
+  return _pShownPlane;
 }
 
+/*********************************************************************
+*
+*       LCD_SwapDisplayBuffers
+*
+* Purpose:
+*   Called once the display shows the display buffer. The display
+*   buffer becomes the shown frame and emWin is pointed at the other
+*   plane, which holds the frame shown before. Only the lines drawn
+*   since the last swap are copied over, so emWin can keep drawing on
+*   top of the shown frame.
+
+* Parameter:
+*   None
+*
+* Return Value:
+*   None
+*/
+void LCD_SwapDisplayBuffers(void)
+{
+  U8 * pPlane;
+  int  y0;
+  int  y1;
+
+  pPlane       = _pShownPlane;
+  _pShownPlane = _pDrawPlane;
+  _pDrawPlane  = pPlane;
+
+  //
+  // Bring the lines drawn since the last swap into the new drawing
+  // plane, so that both planes hold the shown frame again
+  //
+  if (_IsDirty)
+  {
+    y0 = (_DirtyRect.y0 < 0) ? 0 : _DirtyRect.y0;
+    y1 = (_DirtyRect.y1 >= YSIZE_PHYS) ? (YSIZE_PHYS - 1) : _DirtyRect.y1;
+    if (y0 <= y1)
+    {
+      memcpy(_pDrawPlane + (y0 * BYTES_PER_LINE), _pShownPlane + (y0 * BYTES_PER_LINE),
+             (y1 - y0 + 1) * BYTES_PER_LINE);
+    }
+    _IsDirty = 0;
+  }
+
+  //
+  // Re-point the driver to the new drawing plane
+  //
+  _VRAM_Desc.apVRAM[0] = _pDrawPlane;
+  LCD_SetVRAMAddrEx(0, (void *)&_VRAM_Desc);
+}
+
+/*********************************************************************
+*
+*       LCD_AddDirtyRect
+*
+* Purpose:
+*   Adds an area to the dirty rectangle. To be called after writing
+*   into the display buffer without going through emWin.
+
+* Parameter:
+*   x0, y0, x1, y1 - Area written, limits inclusive
+*
+* Return Value:
+*   None
+*/
+void LCD_AddDirtyRect(int x0, int y0, int x1, int y1)
+{
+  _AddDirtyRect(x0, y0, x1, y1);
+}
+
+/*********************************************************************
+*
+*       LCD_GetDirtyRect
+*
+* Purpose:
+*   This function returns the bounding rectangle of the pixels drawn
+*   since the last LCD_SwapDisplayBuffers(). The display buffer and
+*   the shown frame are the same outside of it.
+
+* Parameter:
+*   pRect - Filled with the rectangle, limits inclusive
+*
+* Return Value:
+*   int - 0 if nothing was drawn, 1 otherwise
+*/
+int LCD_GetDirtyRect(LCD_RECT * pRect)
+{
+  *pRect = _DirtyRect;
+  return _IsDirty;
+}
 
 /*************************** End of file ****************************/
@@ -47,6 +47,10 @@ Purpose     : Display driver configuration file
 #include "GUI.h"
 
 extern U8* LCD_GetDisplayBuffer(void);
+extern U8* LCD_GetShownBuffer(void);
+extern void LCD_SwapDisplayBuffers(void);
+extern int LCD_GetDirtyRect(LCD_RECT * pRect);
+extern void LCD_AddDirtyRect(int x0, int y0, int x1, int y1);
 
 #endif /* LCDCONF_H */
 
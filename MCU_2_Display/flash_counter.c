@@ -49,3 +49,27 @@ void increment_flash_counter() {
 	uint16_t counter = get_flash_counter_value();
 	set_flash_counter_value(counter + 1);
 }
+
+bool get_flash_data(uint32_t location, uint8_t *buf, size_t size) {
+    cy_rslt_t result = cy_serial_flash_qspi_read(location, size, buf);
+    if(result != CY_RSLT_SUCCESS) {
+		printf("[INFO] Serial Flash read failed \r\n");
+		return false;
+    }
+
+    return true;
+}
+
+void set_flash_data(uint32_t location, const uint8_t *buf, size_t size) {
+    size_t sectorSize = cy_serial_flash_qspi_get_erase_size(location);
+    cy_rslt_t result = cy_serial_flash_qspi_erase(location, sectorSize);
+
+    if(result != CY_RSLT_SUCCESS) {
+		printf("[INFO] Serial Flash erase failed \r\n");
+    }
+
+    result = cy_serial_flash_qspi_write(location, size, buf);
+    if(result != CY_RSLT_SUCCESS) {
+		printf("[INFO] Serial Flash write failed \r\n");
+    }
+}
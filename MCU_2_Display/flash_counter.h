@@ -14,10 +14,16 @@ void set_flash_counter_value(uint16_t counter);
 
 void increment_flash_counter();
 
+bool get_flash_data(uint32_t location, uint8_t *buf, size_t size);
+
+void set_flash_data(uint32_t location, const uint8_t *buf, size_t size);
+
 #define QSPI_BUS_FREQUENCY_HZ   (50000000lu)
 #define MEM_SLOT_NUM            (0u)      /* Slot number of the memory to use */
 #define FLASH_COUNTER_SIZE		(2u)	/* Number of bytes, which will count number of resets */
 #define FLASH_COUNTER_LOCATION	(0x0u) /* location a reset counter in flash */
+#define BOOKING_SNAPSHOT_LOCATION	(0x40000u) /* location of the booking shown on the display, in the next 256 KB sector */
+#define GATT_CACHE_LOCATION		(0x80000u) /* location of the GATT handles of the booking server, in the sector after */
 
 
 
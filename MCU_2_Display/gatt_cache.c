@@ -0,0 +1,152 @@
+#include "gatt_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "flash_counter.h"
+
+#define GATT_CACHE_MAGIC		(0x47415443u)
+
+/* Service, characteristic and descriptor handles of the custom services */
+#define GATT_CACHE_MAX_HANDLES	(32u)
+
+typedef struct {
+	uint32_t magic;
+	uint8_t peer_addr[CY_BLE_BD_ADDR_SIZE];
+	uint8_t peer_addr_type;
+	bool handles_valid;
+	bool db_hash_valid;
+	uint8_t db_hash[GATT_DB_HASH_SIZE];
+	cy_stc_ble_gattc_t gatt;
+	uint16_t handle_count;
+	cy_ble_gatt_db_attr_handle_t handles[GATT_CACHE_MAX_HANDLES];
+} gatt_cache_t;
+
+static gatt_cache_t cache;
+static bool cache_valid = false;
+
+/* Copy a handle of the custom services to the cache, or back */
+static void copy_handle(cy_ble_gatt_db_attr_handle_t *handle, bool restore) {
+	if(cache.handle_count >= GATT_CACHE_MAX_HANDLES) {
+		return;
+	}
+	if(restore) {
+		*handle = cache.handles[cache.handle_count];
+	} else {
+		cache.handles[cache.handle_count] = *handle;
+	}
+	cache.handle_count++;
+}
+
+/* Walk the handles of the custom services in a fixed order. The handles of
+   the first client are used, as there is a single connection */
+static void copy_handles(bool restore) {
+	const cy_stc_ble_customc_t *service;
+	const cy_stc_ble_customc_char_t *characteristic;
+
+	cache.handle_count = 0u;
+	for(uint8_t s = 0u; s < CY_BLE_CONFIG_CUSTOMC_SERVICE_COUNT; s++) {
+		service = &cy_ble_customCServ[s];
+		copy_handle(&service->customServHandle[0], restore);
+		for(uint8_t c = 0u; c < service->charCount; c++) {
+			characteristic = &service->customServChar[c];
+			copy_handle(&characteristic->customServCharHandle[0], restore);
+			copy_handle(&characteristic->customServCharEndHandle[0], restore);
+			for(uint8_t d = 0u; d < characteristic->descCount; d++) {
+				copy_handle(&characteristic->customServCharDesc[d].descHandle[0], restore);
+			}
+		}
+	}
+}
+
+static bool same_peer(const cy_stc_ble_bd_addr_t *peer) {
+	return (cache.peer_addr_type == peer->type) &&
+	       (memcmp(cache.peer_addr, peer->bdAddr, CY_BLE_BD_ADDR_SIZE) == 0);
+}
+
+void gatt_cache_init(void) {
+	cache_valid = get_flash_data(GATT_CACHE_LOCATION, (uint8_t*)&cache, sizeof(cache)) &&
+	              (cache.magic == GATT_CACHE_MAGIC);
+}
+
+bool gatt_cache_get_peer(cy_stc_ble_bd_addr_t *peer) {
+	if(!cache_valid) {
+		return false;
+	}
+	memcpy(peer->bdAddr, cache.peer_addr, CY_BLE_BD_ADDR_SIZE);
+	peer->type = cache.peer_addr_type;
+	return true;
+}
+
+bool gatt_cache_has_peer(const cy_stc_ble_bd_addr_t *peer) {
+	return cache_valid && cache.handles_valid && same_peer(peer);
+}
+
+/* Restore the handles if they were found on the same server, with the same
+   database hash. Without a database hash (db_hash NULL) a change of the
+   server database cannot be told, so the handles are discovered again */
+bool gatt_cache_restore(const cy_stc_ble_bd_addr_t *peer, const uint8_t *db_hash, uint16_t db_hash_len) {
+	if(!gatt_cache_has_peer(peer)) {
+		return false;
+	}
+
+	if((db_hash == NULL) || !cache.db_hash_valid || (db_hash_len != GATT_DB_HASH_SIZE) ||
+	   (memcmp(cache.db_hash, db_hash, GATT_DB_HASH_SIZE) != 0)) {
+		return false;
+	}
+
+	copy_handles(true);
+	cy_ble_gattcConfigPtr->attrInfo[Cy_BLE_GetDiscoveryIdx(cy_ble_connHandle[0])] = cache.gatt;
+	return true;
+}
+
+/* Keep the handles found by the discovery. The handles of a server without a
+   database hash could not be checked, so only its address is kept */
+/* The stored record needs no rewrite when it names the same server with the
+   same database hash; handles found under the same hash are the same. Every
+   discovery of a server without a hash would otherwise erase the sector */
+static bool stored_unchanged(void) {
+	static gatt_cache_t stored;
+
+	return get_flash_data(GATT_CACHE_LOCATION, (uint8_t*)&stored, sizeof(stored)) &&
+	       (stored.magic == cache.magic) &&
+	       (stored.peer_addr_type == cache.peer_addr_type) &&
+	       (memcmp(stored.peer_addr, cache.peer_addr, CY_BLE_BD_ADDR_SIZE) == 0) &&
+	       (stored.handles_valid == cache.handles_valid) &&
+	       (stored.db_hash_valid == cache.db_hash_valid) &&
+	       (!cache.db_hash_valid ||
+	        (memcmp(stored.db_hash, cache.db_hash, GATT_DB_HASH_SIZE) == 0));
+}
+
+void gatt_cache_save(const cy_stc_ble_bd_addr_t *peer, const uint8_t *db_hash, uint16_t db_hash_len) {
+	cache.magic = GATT_CACHE_MAGIC;
+	memcpy(cache.peer_addr, peer->bdAddr, CY_BLE_BD_ADDR_SIZE);
+	cache.peer_addr_type = peer->type;
+	cache.db_hash_valid = (db_hash != NULL) && (db_hash_len == GATT_DB_HASH_SIZE);
+	cache.handles_valid = cache.db_hash_valid;
+	if(cache.db_hash_valid) {
+		memcpy(cache.db_hash, db_hash, GATT_DB_HASH_SIZE);
+	}
+	cache.gatt = cy_ble_gattcConfigPtr->attrInfo[Cy_BLE_GetDiscoveryIdx(cy_ble_connHandle[0])];
+	copy_handles(false);
+
+	if(!stored_unchanged()) {
+		set_flash_data(GATT_CACHE_LOCATION, (const uint8_t*)&cache, sizeof(cache));
+	}
+	cache_valid = true;
+	if(cache.handles_valid) {
+		printf("[INFO] : GATT handles saved \r\n");
+	} else {
+		printf("[INFO] : GATT server has no database hash, handles not saved \r\n");
+	}
+}
+
+/* Drop the handles; the server address is kept for the next connection */
+void gatt_cache_invalidate(void) {
+	if(!cache_valid || !cache.handles_valid) {
+		return;
+	}
+	cache.handles_valid = false;
+	set_flash_data(GATT_CACHE_LOCATION, (const uint8_t*)&cache, sizeof(cache));
+	printf("[INFO] : GATT handles invalidated \r\n");
+}
@@ -0,0 +1,28 @@
+#ifndef GATT_CACHE_H_
+#define GATT_CACHE_H_
+
+#include "cycfg.h"
+#include "cycfg_ble.h"
+
+/* GATT Database Hash characteristic of the Generic Attribute service */
+#define GATT_DB_HASH_UUID		(0x2B2Au)
+#define GATT_DB_HASH_SIZE		(16u)
+
+/* Handles of the booking server found by the discovery, kept in the serial
+   flash with the server address and its database hash, so that the next
+   connections to the same server can skip the discovery */
+
+void gatt_cache_init(void);
+
+/* Address of the last server, kept when its handles are dropped */
+bool gatt_cache_get_peer(cy_stc_ble_bd_addr_t *peer);
+
+bool gatt_cache_has_peer(const cy_stc_ble_bd_addr_t *peer);
+
+bool gatt_cache_restore(const cy_stc_ble_bd_addr_t *peer, const uint8_t *db_hash, uint16_t db_hash_len);
+
+void gatt_cache_save(const cy_stc_ble_bd_addr_t *peer, const uint8_t *db_hash, uint16_t db_hash_len);
+
+void gatt_cache_invalidate(void);
+
+#endif /* GATT_CACHE_H_ */
@@ -14,6 +14,7 @@
 #include "eink_task.h"
 #include "main_fsm.h"
 #include "flash_counter.h"
+#include "gatt_cache.h"
 
 
 void handle_error(void)
@@ -72,6 +73,7 @@ int main(void)
 	printf("**********************************************************\r\n");
 
     flash_counter_init();
+    gatt_cache_init();
 
     printf("Reset reason: %d\r\n", (int) Cy_SysLib_GetResetReason());
     if(CY_SYSLIB_RESET_HIB_WAKEUP == Cy_SysLib_GetResetReason())
@@ -3,9 +3,12 @@
 #include "cy_retarget_io.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "cy_ble_event_handler.h"
 
 #include "eink_task.h"
 #include "cfg.h"
+#include "cy_eink_power_session.h"
+#include "gatt_cache.h"
 
 
 typedef struct {
@@ -13,6 +16,8 @@ typedef struct {
 	int name_len;
 	uint8_t *serviceUUID;
 	uint8_t servUUID_len;
+	uint8_t *manufData;
+	uint8_t manufData_len;
 } advInfo_t;
 
 advInfo_t currentAdvInfo;
@@ -21,6 +26,10 @@ static void findAdvInfo(uint8_t *adv, uint8_t len) {
 	memset(&currentAdvInfo, 0, sizeof(currentAdvInfo));
 
 	for(uint8_t i=0; i<len;) {
+		/* Skip a truncated AD structure */
+		if((adv[i] == 0) || (i + adv[i] >= len)) {
+			break;
+		}
 		switch(adv[i+1]) {
 		case 0x07:
 			currentAdvInfo.serviceUUID = &adv[i+2];
@@ -30,14 +39,81 @@ static void findAdvInfo(uint8_t *adv, uint8_t len) {
 			currentAdvInfo.name = (char*) &adv[i+2];
 			currentAdvInfo.name_len = adv[i]-1;
 			break;
+		case 0xFF:
+			currentAdvInfo.manufData = &adv[i+2];
+			currentAdvInfo.manufData_len = adv[i]-1;
+			break;
 		}
 		i = i + adv[i]+1;
 	}
 }
 
+/* Sizes of the booking values sent by the server: the times are 32-bit and
+   the occupation status 8-bit, little endian. The booking record and the
+   Read Multiple response hold the start time, the end time and the
+   occupation status, followed by the owner name, whose length is the rest of
+   the value */
+#define BOOKING_TIME_SIZE		(4u)
+#define BOOKING_STATUS_SIZE		(1u)
+#define BOOKING_FIXED_SIZE		(2u * BOOKING_TIME_SIZE + BOOKING_STATUS_SIZE)
+
+/* Booking being received from the server */
+static BookingInfo receivedInfo = {
+	.owner_name = {},
+	.owner_name_len = 0,
+	.start_time = 0lu,
+	.end_time = 0lu,
+	.occupation_status = 1
+};
+
+/* Value received with a read followed by a long read, when it does not fit
+   the ATT MTU */
+static uint8_t rxValue[BOOKING_FIXED_SIZE + sizeof(receivedInfo.owner_name)];
+static uint16_t rxValueLen = 0u;
+static bool longReadPending = false;
+
+/* Largest Link Layer payload, and the time to send it on the 1M PHY, asked
+   for with the Data Length Extension */
+#define BLE_DLE_MAX_OCTETS		(251u)
+#define BLE_DLE_MAX_TIME_US		(2120u)
+
+/* Cleared when the server rejects the booking record or Read Multiple
+   requests, so that the next updates do not retry them */
+static bool bookingRecordSupported = true;
+static bool readMultipleSupported = true;
+
+/* Server found by the scan, the key of the GATT cache */
+static cy_stc_ble_bd_addr_t peerAddr;
+
+/* Time given to the last server to answer a direct connection before
+   scanning for it by name, in seconds */
+#define DIRECT_CONNECT_TIMEOUT	(3u)
+
+/* Set when the last server is in the filter accept list of the controller,
+   cleared when it did not answer, to fall back to scanning */
+static bool directConnect = false;
+
+/* Steps between the MTU exchange and the first booking read. The handles are
+   taken from the GATT cache when the database hash of the server is the one
+   saved with them, else they are found by a discovery and saved with the new
+   hash. Service Changed indications are enabled last */
+typedef enum {
+	GATT_SETUP_CHECK_HASH,
+	GATT_SETUP_DISCOVERY,
+	GATT_SETUP_SAVE_HASH,
+	GATT_SETUP_ENABLE_INDICATION,
+	GATT_SETUP_DONE
+} gatt_setup_t;
+
+static gatt_setup_t gattSetup = GATT_SETUP_CHECK_HASH;
+
+static cy_ble_gatt_db_attr_handle_t charHandle(uint16_t characteristic_char_index) {
+	return cy_ble_customCServ[CY_BLE_CUSTOMC_BOOKING_INFO_SERVICE_INDEX].customServChar[characteristic_char_index].customServCharHandle[0];
+}
+
 void readMsg(uint16_t characteristic_char_index) {
 	cy_stc_ble_gattc_read_req_t myVal = {
-		.attrHandle = cy_ble_customCServ[CY_BLE_CUSTOMC_BOOKING_INFO_SERVICE_INDEX].customServChar[characteristic_char_index].customServCharHandle[0],
+		.attrHandle = charHandle(characteristic_char_index),
 		.connHandle = cy_ble_connHandle[0]
 	};
 
@@ -46,6 +122,466 @@ void readMsg(uint16_t characteristic_char_index) {
 	}
 }
 
+/* Read all the booking values in one request. The owner name goes last, as
+   only the last value of a Read Multiple response can have any length */
+static bool readMultipleMsg(void) {
+	static cy_ble_gatt_db_attr_handle_t handles[] = {0u, 0u, 0u, 0u};
+
+	handles[0] = charHandle(CY_BLE_CUSTOMC_BOOKING_INFO_STARTTIME_CHAR_INDEX);
+	handles[1] = charHandle(CY_BLE_CUSTOMC_BOOKING_INFO_ENDTIME_CHAR_INDEX);
+	handles[2] = charHandle(CY_BLE_CUSTOMC_BOOKING_INFO_OCCUPATIONSTATUS_CHAR_INDEX);
+	handles[3] = charHandle(CY_BLE_CUSTOMC_BOOKING_INFO_OWNER_CHAR_INDEX);
+
+	cy_stc_ble_gattc_read_mult_req_t myVal = {
+		.handleListType = {
+			.handleList = handles,
+			.listCount = sizeof(handles) / sizeof(handles[0])
+		},
+		.connHandle = cy_ble_connHandle[0]
+	};
+
+	if(Cy_BLE_GATTC_ReadMultipleCharacteristicValues(&myVal) != CY_BLE_SUCCESS) {
+		printf("BLE GATTC read multiple error \r\n");
+		return false;
+	}
+	return true;
+}
+
+/* Ask the server for the ATT MTU of the configuration and the peer link
+   layer for the largest packets, so that a booking fits one or two packets.
+   Returns false if the MTU exchange could not be started */
+static bool negotiateLinkSize(void) {
+	cy_stc_ble_set_data_length_info_t dataLength = {
+		.bdHandle = cy_ble_connHandle[0].bdHandle,
+		.connMaxTxOctets = BLE_DLE_MAX_OCTETS,
+		.connMaxTxTime = BLE_DLE_MAX_TIME_US,
+		.connMaxRxOctets = BLE_DLE_MAX_OCTETS,
+		.connMaxRxTime = BLE_DLE_MAX_TIME_US
+	};
+	cy_stc_ble_gatt_xchg_mtu_param_t mtuParam = {
+		.connHandle = cy_ble_connHandle[0],
+		.mtu = CY_BLE_GATT_MTU
+	};
+
+	if(Cy_BLE_SetDataLength(&dataLength) != CY_BLE_SUCCESS) {
+		printf("BLE set data length error \r\n");
+	}
+
+	if(Cy_BLE_GATTC_ExchangeMtuReq(&mtuParam) != CY_BLE_SUCCESS) {
+		printf("BLE GATTC MTU exchange error \r\n");
+		return false;
+	}
+	return true;
+}
+
+/* Put the last server in the filter accept list, so that the controller
+   ignores every other advertiser. The connection starts once the list is
+   updated. Returns false if there is no known server */
+static bool acceptKnownPeer(void) {
+	directConnect = false;
+	if(!gatt_cache_get_peer(&peerAddr)) {
+		return false;
+	}
+	if(Cy_BLE_AddDeviceToWhiteList(&peerAddr) != CY_BLE_SUCCESS) {
+		printf("BLE add to filter accept list error \r\n");
+		return false;
+	}
+	directConnect = true;
+	return true;
+}
+
+/* Connect to the last server, or scan for a server by name */
+static void startConnecting(void) {
+	uint8_t scanFilterPolicy;
+	cy_en_ble_api_result_t result;
+
+	if(directConnect) {
+		/* The initiator filter policy comes from the scan configuration: use
+		   the filter accept list for this connection only */
+		scanFilterPolicy = cy_ble_configPtr->discoveryInfo[0].scanFilterPolicy;
+		cy_ble_configPtr->discoveryInfo[0].scanFilterPolicy = CY_BLE_GAPC_CONN_WHITELIST;
+		result = Cy_BLE_GAPC_ConnectDevice(&peerAddr, 0);
+		cy_ble_configPtr->discoveryInfo[0].scanFilterPolicy = scanFilterPolicy;
+
+		if(result == CY_BLE_SUCCESS) {
+			/* Cancelled by the stack on timeout, see CY_BLE_EVT_TIMEOUT */
+			(void) Cy_BLE_StopTimer(&cy_ble_connectingTimeout);
+			cy_ble_connectingTimeout.timeout = DIRECT_CONNECT_TIMEOUT;
+			(void) Cy_BLE_StartTimer(&cy_ble_connectingTimeout);
+			printf("[INFO] : Connecting to the last server \r\n");
+			return;
+		}
+		printf("BLE direct connection error \r\n");
+		directConnect = false;
+	}
+
+	printf("[INFO] : Starting scan \r\n");
+	Cy_BLE_GAPC_StartScan(CY_BLE_SCANNING_FAST, 0);
+}
+
+/* Connect to the hub, directly when it is known */
+static void connectToServer(void) {
+	if(!acceptKnownPeer()) {
+		startConnecting();
+	}
+}
+
+static void startDiscovery(void) {
+	gattSetup = GATT_SETUP_DISCOVERY;
+	if(Cy_BLE_GATTC_StartDiscovery(cy_ble_connHandle[0]) != CY_BLE_SUCCESS) {
+		printf("BLE GATTC discovery error \r\n");
+	}
+}
+
+/* Drop the connection after stale handles, so that the next connection
+   discovers them again; the booking is read again once it is set up */
+static void reconnectToServer(void) {
+	cy_stc_ble_gap_disconnect_info_t disconnectInfo = {
+		.reason = CY_BLE_HCI_ERROR_OTHER_END_TERMINATED_USER,
+		.bdHandle = cy_ble_connHandle[0].bdHandle
+	};
+
+	longReadPending = false;
+	curr_state = MCU_STATE_CONNECTING;
+	if(Cy_BLE_GAP_Disconnect(&disconnectInfo) == CY_BLE_SUCCESS) {
+		/* Keeps the link from looking set up until the server is connected
+		   again, see CY_BLE_EVT_GATT_CONNECT_IND */
+		gattSetup = GATT_SETUP_CHECK_HASH;
+		return;
+	}
+	printf("BLE disconnect error \r\n");
+	startDiscovery();
+}
+
+/* Read the Database Hash of the server. Returns false if the read could not
+   be started */
+static bool readDbHash(void) {
+	cy_stc_ble_gattc_read_by_type_req_t myVal = {
+		.range = {
+			.startHandle = 0x0001u,
+			.endHandle = 0xFFFFu
+		},
+		.uuid = {
+			.uuid16 = GATT_DB_HASH_UUID
+		},
+		.uuidFormat = CY_BLE_GATT_16_BIT_UUID_FORMAT,
+		.connHandle = cy_ble_connHandle[0]
+	};
+
+	if(Cy_BLE_GATTC_ReadUsingCharacteristicUuid(&myVal) != CY_BLE_SUCCESS) {
+		printf("BLE GATTC read database hash error \r\n");
+		return false;
+	}
+	return true;
+}
+
+/* Enable the Service Changed indications, so that a change of the server
+   database drops the GATT cache, then let the booking reads start */
+static void enableServiceChanged(void) {
+	static uint8_t cccdValue[CY_BLE_CCCD_LEN] = {CY_BLE_CCCD_INDICATION, 0u};
+	cy_stc_ble_gattc_write_req_t myVal = {
+		.handleValPair = {
+			.value = {
+				.val = cccdValue,
+				.len = CY_BLE_CCCD_LEN
+			},
+			.attrHandle = cy_ble_gattcConfigPtr->attrInfo[Cy_BLE_GetDiscoveryIdx(cy_ble_connHandle[0])].cccdHandle
+		},
+		.connHandle = cy_ble_connHandle[0]
+	};
+
+	if((myVal.handleValPair.attrHandle == CY_BLE_GATT_INVALID_ATTR_HANDLE_VALUE) ||
+	   (Cy_BLE_GATTC_WriteCharacteristicDescriptors(&myVal) != CY_BLE_SUCCESS)) {
+		gattSetup = GATT_SETUP_DONE;
+		return;
+	}
+	gattSetup = GATT_SETUP_ENABLE_INDICATION;
+}
+
+/* Check the database hash of a known server against the GATT cache, or
+   discover an unknown one */
+static void startGattSetup(void) {
+	if(gatt_cache_has_peer(&peerAddr) && readDbHash()) {
+		gattSetup = GATT_SETUP_CHECK_HASH;
+	} else {
+		startDiscovery();
+	}
+}
+
+/* Continue the setup with the database hash of the server, NULL if it has
+   none */
+static void dbHashReceived(const uint8_t *hash, uint16_t len) {
+	if(gattSetup == GATT_SETUP_CHECK_HASH) {
+		/* Register the connection for the client attributes, as the
+		   discovery does, then mark it discovered */
+		(void) Cy_BLE_GATTC_AddConnHandle(cy_ble_connHandle[0]);
+		if(!gatt_cache_restore(&peerAddr, hash, len)) {
+			startDiscovery();
+			return;
+		}
+		printf("[INFO] : GATT handles restored \r\n");
+		Cy_BLE_SetConnectionState(cy_ble_connHandle[0], CY_BLE_CONN_STATE_CLIENT_DISCOVERED);
+	} else {
+		gatt_cache_save(&peerAddr, hash, len);
+	}
+	enableServiceChanged();
+}
+
+/* First step of a booking update: the booking record when the server offers
+   one, else all the values at once, else one value at a time */
+static updating_state_t firstUpdatingState(void) {
+	if(bookingRecordSupported &&
+	   (charHandle(CY_BLE_CUSTOMC_BOOKING_INFO_BOOKINGRECORD_CHAR_INDEX) != CY_BLE_GATT_INVALID_ATTR_HANDLE_VALUE)) {
+		return UPDATING_INFO_RECORD;
+	}
+	if(readMultipleSupported) {
+		return UPDATING_INFO_MULTIPLE;
+	}
+	return UPDATING_INFO_START_TIME;
+}
+
+static uint32_t readLe32(const uint8_t *val) {
+	return (uint32_t)val[0] | ((uint32_t)val[1] << 8) |
+	       ((uint32_t)val[2] << 16) | ((uint32_t)val[3] << 24);
+}
+
+/* Decode a booking record or a Read Multiple response into receivedInfo in
+   one pass. Returns false if the value is too short */
+static bool decodeBookingInfo(const uint8_t *val, uint16_t len) {
+	uint16_t name_len;
+
+	if(len < BOOKING_FIXED_SIZE) {
+		return false;
+	}
+
+	receivedInfo.start_time = (time_t) readLe32(&val[0]);
+	receivedInfo.end_time = (time_t) readLe32(&val[BOOKING_TIME_SIZE]);
+	receivedInfo.occupation_status = (val[2u * BOOKING_TIME_SIZE] != 0u);
+
+	name_len = len - BOOKING_FIXED_SIZE;
+	if(name_len > sizeof(receivedInfo.owner_name) - 1u) {
+		name_len = sizeof(receivedInfo.owner_name) - 1u;
+	}
+	memcpy(receivedInfo.owner_name, &val[BOOKING_FIXED_SIZE], name_len);
+	receivedInfo.owner_name_len = name_len;
+	receivedInfo.owner_name[name_len] = '\0';
+
+	return true;
+}
+
+#if(BOOKING_SOURCE == BOOKING_SOURCE_ADV)
+/* Booking broadcast by the hub in the manufacturer specific data of its
+   advertising: company identifier, payload version and sequence counter,
+   followed by a booking record and by the first bytes of the AES-CMAC of all
+   the previous bytes. The hub increments the counter with each booking, so
+   that an older payload cannot be replayed */
+#define BOOKING_ADV_COMPANY_ID		(0x0131u)
+#define BOOKING_ADV_VERSION		(1u)
+#define BOOKING_ADV_HEADER_SIZE	(7u)
+#define BOOKING_ADV_MAC_SIZE		(4u)
+
+/* Passive scan of 112.5 ms every 500 ms, for at most 2 s, in 0.625 ms units
+   and seconds */
+#define BOOKING_ADV_SCAN_INTERVAL	(800u)
+#define BOOKING_ADV_SCAN_WINDOW		(180u)
+#define BOOKING_ADV_SCAN_TIMEOUT	(2u)
+
+/* Counter of the last booking taken from the advertising, kept in backup
+   registers. They hold it through hibernate and resets, without wearing the
+   serial flash; only a loss of the backup supply clears it, after which the
+   first authentic broadcast is taken */
+#define BOOKING_ADV_BREG_MAGIC		(0u)
+#define BOOKING_ADV_BREG_COUNTER	(1u)
+#define BOOKING_ADV_COUNTER_MAGIC	(0x42414443u)
+
+#ifndef BOOKING_ADV_KEY
+#error "BOOKING_SOURCE_ADV needs the key of the hub: define BOOKING_ADV_KEY in cfg.h"
+#endif
+
+CY_ALIGN(4) static const uint8_t bookingAdvKey[CY_CRYPTO_AES_BLOCK_SIZE] = BOOKING_ADV_KEY;
+
+/* Set while scanning for the booking broadcast, once a new booking is 
+   received, and once the last booking is received again */
+static bool observing = false;
+static bool bookingAdvReceived = false;
+static bool bookingAdvUnchanged = false;
+
+/* Scan configuration of the connection, changed while observing */
+static cy_stc_ble_gapc_disc_info_t connectScanInfo;
+
+static bool checkBookingAdvMac(const uint8_t *payload, uint8_t len) {
+	CY_ALIGN(4) static uint8_t message[CY_BLE_GAP_MAX_ADV_DATA_LEN];
+	CY_ALIGN(4) static uint8_t mac[CY_CRYPTO_AES_BLOCK_SIZE];
+	cy_stc_crypto_aes_state_t aesState;
+
+	if(!Cy_Crypto_Core_IsEnabled(CRYPTO) && (Cy_Crypto_Core_Enable(CRYPTO) != CY_CRYPTO_SUCCESS)) {
+		return false;
+	}
+
+	/* The crypto block wants the message word aligned */
+	memcpy(message, payload, len - BOOKING_ADV_MAC_SIZE);
+	if(Cy_Crypto_Core_Cmac(CRYPTO, message, len - BOOKING_ADV_MAC_SIZE, bookingAdvKey,
+	                       CY_CRYPTO_KEY_AES_128, mac, &aesState) != CY_CRYPTO_SUCCESS) {
+		return false;
+	}
+	return memcmp(mac, &payload[len - BOOKING_ADV_MAC_SIZE], BOOKING_ADV_MAC_SIZE) == 0;
+}
+
+static bool getBookingAdvCounter(uint32_t *counter) {
+	if(BACKUP->BREG[BOOKING_ADV_BREG_MAGIC] != BOOKING_ADV_COUNTER_MAGIC) {
+		return false;
+	}
+	*counter = BACKUP->BREG[BOOKING_ADV_BREG_COUNTER];
+	return true;
+}
+
+static void setBookingAdvCounter(uint32_t counter) {
+	BACKUP->BREG[BOOKING_ADV_BREG_COUNTER] = counter;
+	BACKUP->BREG[BOOKING_ADV_BREG_MAGIC] = BOOKING_ADV_COUNTER_MAGIC;
+}
+
+/* Decode the booking broadcast by the hub into receivedInfo. Returns false
+   if the manufacturer data is not a booking, not an authentic one, or not a
+   newer one than the last booking taken */
+static bool decodeBookingAdv(const uint8_t *data, uint8_t len) {
+	uint32_t counter;
+	uint32_t lastCounter;
+
+	if((len < BOOKING_ADV_HEADER_SIZE + BOOKING_FIXED_SIZE + BOOKING_ADV_MAC_SIZE) ||
+	   ((data[0] | ((uint16_t)data[1] << 8)) != BOOKING_ADV_COMPANY_ID) ||
+	   (data[2] != BOOKING_ADV_VERSION)) {
+		return false;
+	}
+
+	counter = readLe32(&data[3]);
+	if(getBookingAdvCounter(&lastCounter) && (counter <= lastCounter)) {
+		/* The hub keeps broadcasting its last booking: an authentic copy of
+		   the booking already taken means that there is no new one */
+		if((counter == lastCounter) && checkBookingAdvMac(data, len)) {
+			bookingAdvUnchanged = true;
+		} else {
+			printf("[INFO] : Old booking broadcast \r\n");
+		}
+		return false;
+	}
+	if(!checkBookingAdvMac(data, len)) {
+		printf("[INFO] : Booking broadcast not authentic \r\n");
+		return false;
+	}
+
+	if(!decodeBookingInfo(&data[BOOKING_ADV_HEADER_SIZE],
+	                      len - BOOKING_ADV_HEADER_SIZE - BOOKING_ADV_MAC_SIZE)) {
+		return false;
+	}
+	setBookingAdvCounter(counter);
+	return true;
+}
+
+/* Scan passively, with a low duty cycle, for the booking broadcast by the
+   hub. The scan stops as soon as it is received */
+static void startObserving(void) {
+	cy_stc_ble_gapc_disc_info_t *scanInfo = &cy_ble_configPtr->discoveryInfo[0];
+
+	connectScanInfo = *scanInfo;
+	scanInfo->discProcedure = CY_BLE_GAPC_OBSER_PROCEDURE;
+	scanInfo->scanType = CY_BLE_GAPC_PASSIVE_SCANNING;
+	scanInfo->scanIntv = BOOKING_ADV_SCAN_INTERVAL;
+	scanInfo->scanWindow = BOOKING_ADV_SCAN_WINDOW;
+	scanInfo->scanTo = BOOKING_ADV_SCAN_TIMEOUT;
+
+	bookingAdvReceived = false;
+	bookingAdvUnchanged = false;
+	observing = (Cy_BLE_GAPC_StartScan(CY_BLE_SCANNING_CUSTOM, 0) == CY_BLE_SUCCESS);
+	if(!observing) {
+		*scanInfo = connectScanInfo;
+		connectToServer();
+	}
+}
+
+/* Use the booking broadcast, or connect to the hub when none was received */
+static void observingStopped(void) {
+	observing = false;
+	cy_ble_configPtr->discoveryInfo[0] = connectScanInfo;
+	if(!bookingAdvReceived && !bookingAdvUnchanged) {
+		printf("[INFO] : No booking broadcast \r\n");
+		connectToServer();
+	}
+}
+#endif
+
+/* A response that fills the ATT MTU may have cut the value short */
+static bool responseFull(uint16_t len) {
+	cy_stc_ble_gatt_xchg_mtu_param_t mtuParam = {
+		.connHandle = cy_ble_connHandle[0]
+	};
+
+	if(Cy_BLE_GATT_GetMtuSize(&mtuParam) != CY_BLE_SUCCESS) {
+		return true;
+	}
+	return len >= (mtuParam.mtu - 1u);
+}
+
+static void appendValue(const uint8_t *val, uint16_t len) {
+	if(len > sizeof(rxValue) - rxValueLen) {
+		len = sizeof(rxValue) - rxValueLen;
+	}
+	memcpy(&rxValue[rxValueLen], val, len);
+	rxValueLen += len;
+}
+
+/* Keep the value of a read response and, if it fills the ATT MTU, read the
+   rest of it with a long read. Returns true if the value is complete */
+static bool receiveValue(uint16_t characteristic_char_index, const cy_stc_ble_gatt_value_t *value) {
+	rxValueLen = 0u;
+	appendValue(value->val, value->len);
+
+	if(!responseFull(value->len)) {
+		return true;
+	}
+
+	cy_stc_ble_gattc_read_blob_req_t myVal = {
+		.handleOffset = {
+			.attrHandle = charHandle(characteristic_char_index),
+			.offset = value->len
+		},
+		.connHandle = cy_ble_connHandle[0]
+	};
+
+	if(Cy_BLE_GATTC_ReadLongCharacteristicValues(&myVal) != CY_BLE_SUCCESS) {
+		printf("BLE GATTC read long error \r\n");
+		return true;
+	}
+	longReadPending = true;
+	return false;
+}
+
+/* Store the complete value of the booking record or of the owner name and
+   finish the update */
+static void valueReceived(void) {
+	uint16_t name_len;
+
+	if(curr_upd_state == UPDATING_INFO_RECORD) {
+		if(!decodeBookingInfo(rxValue, rxValueLen)) {
+			bookingRecordSupported = false;
+			curr_upd_state = firstUpdatingState();
+			curr_state = MCU_STATE_UPDATING_INFO;
+			return;
+		}
+	} else {
+		name_len = rxValueLen;
+		if(name_len > sizeof(receivedInfo.owner_name) - 1u) {
+			name_len = sizeof(receivedInfo.owner_name) - 1u;
+		}
+		memcpy(receivedInfo.owner_name, rxValue, name_len);
+		receivedInfo.owner_name_len = name_len;
+		receivedInfo.owner_name[name_len] = '\0';
+	}
+
+	curr_upd_state = UPDATING_INFO_FINISHED;
+	curr_state = MCU_STATE_UPDATING_INFO;
+	booking_info = receivedInfo;
+}
+
 void main_fsm(void* pvParameters) {
 	for(;;) {
 		if(mcwdt_intr_flag) {
@@ -66,9 +602,28 @@ void main_fsm(void* pvParameters) {
 			}
 			case MCU_STATE_CONNECTING: {
 				Cy_BLE_ProcessEvents();
-				if(Cy_BLE_GetConnectionState(app_conn_handle) == CY_BLE_CONN_STATE_CLIENT_DISCOVERED) {
+#if(BOOKING_SOURCE == BOOKING_SOURCE_ADV)
+				if(bookingAdvReceived && !observing) {
+					bookingAdvReceived = false;
 					curr_state = MCU_STATE_UPDATING_INFO;
-					curr_upd_state = UPDATING_INFO_START_TIME;
+					curr_upd_state = UPDATING_INFO_FINISHED;
+					cyhal_gpio_write((cyhal_gpio_t)CYBSP_USER_LED1, CYBSP_LED_STATE_ON);
+					break;
+				}
+				/* The display already shows the booking broadcast */
+				if(bookingAdvUnchanged && !observing) {
+					bookingAdvUnchanged = false;
+					curr_state = MCU_STATE_DEEP_SLEEP;
+					break;
+				}
+#endif
+				if((Cy_BLE_GetConnectionState(app_conn_handle) == CY_BLE_CONN_STATE_CLIENT_DISCOVERED) &&
+				   (gattSetup == GATT_SETUP_DONE)) {
+					curr_state = MCU_STATE_UPDATING_INFO;
+					curr_upd_state = firstUpdatingState();
+					/* Measure the die temperature for the display refresh; the
+					   result arrives while the booking info is read */
+					Cy_BLE_GetTemperature();
 					cyhal_gpio_write((cyhal_gpio_t)CYBSP_USER_LED1, CYBSP_LED_STATE_ON);
 				} else {
 					cyhal_gpio_toggle((cyhal_gpio_t)CYBSP_USER_LED1);
@@ -77,6 +632,20 @@ void main_fsm(void* pvParameters) {
 			}
 			case MCU_STATE_UPDATING_INFO: {
 				switch(curr_upd_state) {
+					case UPDATING_INFO_RECORD: {
+						readMsg(CY_BLE_CUSTOMC_BOOKING_INFO_BOOKINGRECORD_CHAR_INDEX);
+						curr_state = MCU_STATE_UPDATING_INFO_PROCESSING;
+						break;
+					}
+					case UPDATING_INFO_MULTIPLE: {
+						if(readMultipleMsg()) {
+							curr_state = MCU_STATE_UPDATING_INFO_PROCESSING;
+						} else {
+							readMultipleSupported = false;
+							curr_upd_state = UPDATING_INFO_START_TIME;
+						}
+						break;
+					}
 					case UPDATING_INFO_START_TIME: {
 						readMsg(CY_BLE_CUSTOMC_BOOKING_INFO_STARTTIME_CHAR_INDEX);
 						curr_state = MCU_STATE_UPDATING_INFO_PROCESSING;
@@ -87,13 +656,13 @@ void main_fsm(void* pvParameters) {
 						curr_state = MCU_STATE_UPDATING_INFO_PROCESSING;
 						break;
 					}
-					case UPDATING_INFO_OWNER_NAME: {
-						readMsg(CY_BLE_CUSTOMC_BOOKING_INFO_OWNER_CHAR_INDEX);
+					case UPDATING_INFO_OCCUPATION_STATUS: {
+						readMsg(CY_BLE_CUSTOMC_BOOKING_INFO_OCCUPATIONSTATUS_CHAR_INDEX);
 						curr_state = MCU_STATE_UPDATING_INFO_PROCESSING;
 						break;
 					}
-					case UPDATING_INFO_OCCUPATION_STATUS: {
-						readMsg(CY_BLE_CUSTOMC_BOOKING_INFO_OCCUPATIONSTATUS_CHAR_INDEX);
+					case UPDATING_INFO_OWNER_NAME: {
+						readMsg(CY_BLE_CUSTOMC_BOOKING_INFO_OWNER_CHAR_INDEX);
 						curr_state = MCU_STATE_UPDATING_INFO_PROCESSING;
 						break;
 					}
@@ -157,16 +726,62 @@ void stack_event_handler(uint32_t event, void* eventParam) {
 
         /* This event is received when the BLE stack is started */
         case CY_BLE_EVT_STACK_ON:
+        {
+#if(BOOKING_SOURCE == BOOKING_SOURCE_ADV)
+            startObserving();
+#else
+            connectToServer();
+#endif
+            break;
+        }
+
         case CY_BLE_EVT_GAP_DEVICE_DISCONNECTED:
         {
-            printf("[INFO] : Starting scan \r\n");
-            Cy_BLE_GAPC_StartScan(CY_BLE_SCANNING_FAST, 0);
+            startConnecting();
+            break;
+        }
+
+        /* This event indicates that the last server is in the filter accept list */
+        case CY_BLE_EVT_ADD_DEVICE_TO_WHITE_LIST_COMPLETE:
+        {
+            if(((cy_stc_ble_events_param_generic_t *)eventParam)->status != 0u) {
+                printf("BLE add to filter accept list error \r\n");
+                directConnect = false;
+            }
+            startConnecting();
+            break;
+        }
+
+        /* This event indicates that the last server did not answer the direct
+           connection, which the stack has cancelled */
+        case CY_BLE_EVT_TIMEOUT:
+        {
+            cy_stc_ble_timeout_param_t *timeoutParam = (cy_stc_ble_timeout_param_t *)eventParam;
+            if((timeoutParam->reasonCode == CY_BLE_GENERIC_APP_TO) &&
+               (timeoutParam->timerHandle == cy_ble_connectingTimeout.timerHandle) && directConnect) {
+                printf("[INFO] : Last server not found \r\n");
+                directConnect = false;
+                startConnecting();
+            }
+            break;
+        }
+
+        /* This event carries the temperature of the BLE radio die */
+        case CY_BLE_EVT_RADIO_TEMPERATURE:
+        {
+            printf("[INFO] : Die temperature: %d C\r\n", *(int16_t *) eventParam);
+            eink_set_die_temperature(*(int16_t *) eventParam);
             break;
         }
 
         case CY_BLE_EVT_GAPC_SCAN_START_STOP:
         {
         	printf("[INFO] : GAPC Start/Stop scanning \r\n");
+#if(BOOKING_SOURCE == BOOKING_SOURCE_ADV)
+        	if(observing && (Cy_BLE_GetScanState() == CY_BLE_SCAN_STATE_STOPPED)) {
+        		observingStopped();
+        	}
+#endif
         	break;
         }
 
@@ -219,16 +834,35 @@ void stack_event_handler(uint32_t event, void* eventParam) {
 
         	printf("\r\n");
 
+#if(BOOKING_SOURCE == BOOKING_SOURCE_ADV)
+        	if(observing) {
+        		if(!bookingAdvReceived && !bookingAdvUnchanged && (currentAdvInfo.manufData_len != 0)) {
+        			if(decodeBookingAdv(currentAdvInfo.manufData, currentAdvInfo.manufData_len)) {
+        				printf("[INFO] : Booking broadcast received \r\n");
+        				booking_info = receivedInfo;
+        				bookingAdvReceived = true;
+        				/* Measure the die temperature for the display refresh, while
+        				   the scan stops */
+        				Cy_BLE_GetTemperature();
+        				Cy_BLE_GAPC_StopScan();
+        			} else if(bookingAdvUnchanged) {
+        				printf("[INFO] : Booking broadcast unchanged \r\n");
+        				Cy_BLE_GAPC_StopScan();
+        			}
+        		}
+        		break;
+        	}
+#endif
+
         	if(currentAdvInfo.name_len > 0) {
 				currentAdvInfo.name[currentAdvInfo.name_len] = '\0';
 
 				if(!strcmp(currentAdvInfo.name, "BLE UART Target"))
 				{
 					printf("[INFO] : Found LineData Service \r\n");
-					cy_stc_ble_bd_addr_t connectAddr;
-					memcpy(&connectAddr.bdAddr[0], &scanProgressParam->peerBdAddr[0], CY_BLE_BD_ADDR_SIZE);
-					connectAddr.type = scanProgressParam->peerAddrType;
-					Cy_BLE_GAPC_ConnectDevice(&connectAddr, 0);
+					memcpy(&peerAddr.bdAddr[0], &scanProgressParam->peerBdAddr[0], CY_BLE_BD_ADDR_SIZE);
+					peerAddr.type = scanProgressParam->peerAddrType;
+					Cy_BLE_GAPC_ConnectDevice(&peerAddr, 0);
 					Cy_BLE_GAPC_StopScan();
 				}
         	}
@@ -245,7 +879,65 @@ void stack_event_handler(uint32_t event, void* eventParam) {
         case CY_BLE_EVT_GATT_CONNECT_IND:
         {
             printf("[INFO] : GATT device connected\r\n");
-            Cy_BLE_GATTC_StartDiscovery(cy_ble_connHandle[0]);
+            /* The GATT setup starts once the MTU has been exchanged */
+            gattSetup = GATT_SETUP_CHECK_HASH;
+            if(!negotiateLinkSize()) {
+                startGattSetup();
+            }
+            break;
+        }
+
+        /* This event indicates that the 'GATT MTU Exchange Response' is received */
+        case CY_BLE_EVT_GATTC_XCHNG_MTU_RSP:
+        {
+            printf("[INFO] : GATT MTU: server %d\r\n", ((cy_stc_ble_gatt_xchg_mtu_param_t *)eventParam)->mtu);
+            startGattSetup();
+            break;
+        }
+
+        /* This event indicates that the handles of the server are discovered */
+        case CY_BLE_EVT_GATTC_DISCOVERY_COMPLETE:
+        {
+            printf("[INFO] : GATT discovery complete\r\n");
+            gattSetup = GATT_SETUP_SAVE_HASH;
+            if(!readDbHash()) {
+                dbHashReceived(NULL, 0u);
+            }
+            break;
+        }
+
+        /* This event carries an indication of the server. An indication of
+           the Service Changed characteristic means that the server database
+           has changed: the handles are discovered again at the next connection */
+        case CY_BLE_EVT_GATTC_INDICATION:
+        {
+            cy_stc_ble_gattc_handle_value_ind_param_t *indicationParam = (cy_stc_ble_gattc_handle_value_ind_param_t *)eventParam;
+            if(indicationParam->handleValPair.attrHandle ==
+               cy_ble_gattcConfigPtr->attrInfo[Cy_BLE_GetDiscoveryIdx(indicationParam->connHandle)].serviceChanged.valueHandle) {
+                printf("[INFO] : GATT service changed\r\n");
+                gatt_cache_invalidate();
+            }
+            break;
+        }
+
+        /* This event carries the database hash, read by its UUID */
+        case CY_BLE_EVT_GATTC_READ_BY_TYPE_RSP:
+        {
+            cy_stc_ble_gattc_read_by_type_rsp_param_t *readByTypeParam = (cy_stc_ble_gattc_read_by_type_rsp_param_t *)eventParam;
+            /* Each element is the handle followed by the value */
+            if(((gattSetup == GATT_SETUP_CHECK_HASH) || (gattSetup == GATT_SETUP_SAVE_HASH)) &&
+               (readByTypeParam->attrData.length > sizeof(cy_ble_gatt_db_attr_handle_t))) {
+                dbHashReceived(&readByTypeParam->attrData.attrValue[sizeof(cy_ble_gatt_db_attr_handle_t)],
+                               readByTypeParam->attrData.length - sizeof(cy_ble_gatt_db_attr_handle_t));
+            }
+            break;
+        }
+
+        /* This event indicates the packet sizes used by the link layer */
+        case CY_BLE_EVT_DATA_LENGTH_CHANGE:
+        {
+            cy_stc_ble_data_length_change_event_param_t *dataLength = (cy_stc_ble_data_length_change_event_param_t *)eventParam;
+            printf("[INFO] : Data length: Tx %d Rx %d\r\n", dataLength->connMaxTxOctets, dataLength->connMaxRxOctets);
             break;
         }
 
@@ -267,6 +959,55 @@ void stack_event_handler(uint32_t event, void* eventParam) {
         case CY_BLE_EVT_GATTC_ERROR_RSP:
         {
         	printf("[INFO] : GATTC error response\r\n");
+        	cy_stc_ble_gatt_err_param_t *errParam = (cy_stc_ble_gatt_err_param_t *)eventParam;
+
+        	/* A server that does not support the MTU exchange keeps the default MTU */
+        	if(errParam->errInfo.opCode == CY_BLE_GATT_XCNHG_MTU_REQ) {
+        		startGattSetup();
+        		break;
+        	}
+
+        	/* A server without a database hash is only matched by its address */
+        	if((gattSetup == GATT_SETUP_CHECK_HASH) || (gattSetup == GATT_SETUP_SAVE_HASH)) {
+        		dbHashReceived(NULL, 0u);
+        		break;
+        	}
+
+        	/* A server that rejects the Service Changed indications still
+        	   serves the bookings */
+        	if(gattSetup == GATT_SETUP_ENABLE_INDICATION) {
+        		gattSetup = GATT_SETUP_DONE;
+        		break;
+        	}
+
+        	/* Handles that are not valid any more come from a stale cache */
+        	if(errParam->errInfo.errorCode == CY_BLE_GATT_ERR_INVALID_HANDLE) {
+        		gatt_cache_invalidate();
+        		reconnectToServer();
+        		break;
+        	}
+
+        	/* A long read of a value whose length is a multiple of the MTU ends
+        	   with an error; keep the part received */
+        	if(longReadPending) {
+        		longReadPending = false;
+        		valueReceived();
+        		break;
+        	}
+
+        	/* Fall back to reading the values one at a time when the server
+        	   rejects the booking record or Read Multiple */
+        	if(curr_state == MCU_STATE_UPDATING_INFO_PROCESSING) {
+        		if(curr_upd_state == UPDATING_INFO_RECORD) {
+        			bookingRecordSupported = false;
+        			curr_upd_state = firstUpdatingState();
+        			curr_state = MCU_STATE_UPDATING_INFO;
+        		} else if(curr_upd_state == UPDATING_INFO_MULTIPLE) {
+        			readMultipleSupported = false;
+        			curr_upd_state = firstUpdatingState();
+        			curr_state = MCU_STATE_UPDATING_INFO;
+        		}
+        	}
         	break;
         }
 
@@ -274,52 +1015,96 @@ void stack_event_handler(uint32_t event, void* eventParam) {
         case CY_BLE_EVT_GATTC_WRITE_RSP:
         {
         	printf("[INFO] : GATTC write response\r\n");
+        	if(gattSetup == GATT_SETUP_ENABLE_INDICATION) {
+        		gattSetup = GATT_SETUP_DONE;
+        	}
             break;
         }
 
         case CY_BLE_EVT_GATTC_READ_RSP:
         {
-
-			static BookingInfo info = {
-				.owner_name = {},
-				.owner_name_len = 0,
-				.start_time = 0lu,
-				.end_time = 0lu,
-				.occupation_status = 1
-			};
-
         	printf("[INFO] : GATTC read response\r\n");
         	cy_stc_ble_gattc_read_rsp_param_t * readRspParam = (cy_stc_ble_gattc_read_rsp_param_t*)eventParam;
+        	if((gattSetup == GATT_SETUP_CHECK_HASH) || (gattSetup == GATT_SETUP_SAVE_HASH)) {
+        		dbHashReceived(readRspParam->value.val, readRspParam->value.len);
+        		break;
+        	}
         	switch(curr_upd_state) {
+        	case UPDATING_INFO_RECORD:
+        		if(receiveValue(CY_BLE_CUSTOMC_BOOKING_INFO_BOOKINGRECORD_CHAR_INDEX, &readRspParam->value)) {
+        			valueReceived();
+        		}
+        		break;
         	case UPDATING_INFO_START_TIME:
-				memcpy((uint8_t*)&info.start_time, readRspParam->value.val, readRspParam->value.len);
+				memcpy((uint8_t*)&receivedInfo.start_time, readRspParam->value.val, readRspParam->value.len);
         		curr_upd_state = UPDATING_INFO_END_TIME;
         		curr_state = MCU_STATE_UPDATING_INFO;
         		break;
         	case UPDATING_INFO_END_TIME:
-				memcpy((uint8_t*)&info.end_time, readRspParam->value.val, readRspParam->value.len);
-        		curr_upd_state = UPDATING_INFO_OWNER_NAME;
-        		curr_state = MCU_STATE_UPDATING_INFO;
-        		break;
-        	case UPDATING_INFO_OWNER_NAME:
-				memcpy((uint8_t*)&info.owner_name, readRspParam->value.val, readRspParam->value.len);
-				info.owner_name_len = readRspParam->value.len;
-				info.owner_name[info.owner_name_len] = '\0';
+				memcpy((uint8_t*)&receivedInfo.end_time, readRspParam->value.val, readRspParam->value.len);
         		curr_upd_state = UPDATING_INFO_OCCUPATION_STATUS;
         		curr_state = MCU_STATE_UPDATING_INFO;
         		break;
         	case UPDATING_INFO_OCCUPATION_STATUS:
-				memcpy((uint8_t*)&info.occupation_status, readRspParam->value.val, readRspParam->value.len);
-        		curr_upd_state = UPDATING_INFO_FINISHED;
+				memcpy((uint8_t*)&receivedInfo.occupation_status, readRspParam->value.val, readRspParam->value.len);
+        		curr_upd_state = UPDATING_INFO_OWNER_NAME;
 				curr_state = MCU_STATE_UPDATING_INFO;
-				booking_info = info;
 				break;
+        	case UPDATING_INFO_OWNER_NAME:
+        		if(receiveValue(CY_BLE_CUSTOMC_BOOKING_INFO_OWNER_CHAR_INDEX, &readRspParam->value)) {
+        			valueReceived();
+        		}
+        		break;
+        	case UPDATING_INFO_MULTIPLE:
         	case UPDATING_INFO_FINISHED:
         		printf("Redundant read req was made \r\n");
         		break;
         	}
             break;
         }
+
+        /* This event carries the next part of a long read */
+        case CY_BLE_EVT_GATTC_READ_BLOB_RSP:
+        {
+        	cy_stc_ble_gattc_read_rsp_param_t * readRspParam = (cy_stc_ble_gattc_read_rsp_param_t*)eventParam;
+        	if(longReadPending) {
+        		appendValue(readRspParam->value.val, readRspParam->value.len);
+        	}
+            break;
+        }
+
+        /* This event indicates that a long read is complete */
+        case CY_BLE_EVT_GATTC_LONG_PROCEDURE_END:
+        {
+        	if(longReadPending) {
+        		longReadPending = false;
+        		valueReceived();
+        	}
+            break;
+        }
+
+        /* This event carries the values of a Read Multiple request, one after
+           the other */
+        case CY_BLE_EVT_GATTC_READ_MULTI_RSP:
+        {
+        	printf("[INFO] : GATTC read multiple response\r\n");
+        	cy_stc_ble_gattc_read_rsp_param_t * readRspParam = (cy_stc_ble_gattc_read_rsp_param_t*)eventParam;
+        	if(curr_upd_state != UPDATING_INFO_MULTIPLE) {
+        		printf("Redundant read req was made \r\n");
+        		break;
+        	}
+        	if(decodeBookingInfo(readRspParam->value.val, readRspParam->value.len)) {
+        		/* Read the owner name alone if it may have been cut short */
+        		curr_upd_state = responseFull(readRspParam->value.len) ?
+        		                 UPDATING_INFO_OWNER_NAME : UPDATING_INFO_FINISHED;
+        		booking_info = receivedInfo;
+        	} else {
+        		readMultipleSupported = false;
+        		curr_upd_state = firstUpdatingState();
+        	}
+        	curr_state = MCU_STATE_UPDATING_INFO;
+            break;
+        }
         default:
         {
             printf("[INFO] : BLE Event 0x%lX\r\n", (unsigned long) event);
@@ -354,11 +1139,22 @@ void enter_low_power_mode(void) {
 	cyhal_gpio_write((cyhal_gpio_t)CYBSP_USER_LED1, CYBSP_LED_STATE_OFF);
 	cyhal_gpio_write((cyhal_gpio_t)CYBSP_LED_RGB_GREEN, CYBSP_LED_STATE_OFF);
 
-
 #if(LOW_POWER_MODE == LOW_POWER_DEEP_SLEEP)
+	/* The idle timeout does not run in deep sleep, and the sleep is longer
+	   than the timeout; turn the display off rather than keep its drive 
+	   voltages on for the whole sleep */
+	Cy_EINK_SessionPowerDown();
+
 	Cy_SysPm_CpuEnterDeepSleep(CY_SYSPM_WAIT_FOR_INTERRUPT);
 #endif
 #if(LOW_POWER_MODE == LOW_POWER_HIBERNATE)
+	/* Hibernate does not retain the display driver; turn the display off 
+	   properly before the power of the driver is lost */
+	Cy_EINK_SessionPowerDown();
+
+	/* The RAM is lost as well; keep the booking the display shows */
+	save_booking_snapshot();
+
         /* Wait until UART transfer complete  */
         while(0UL == Cy_SCB_UART_IsTxComplete(cy_retarget_io_uart_obj.base));
         Cy_SysPm_Hibernate();
@@ -0,0 +1,292 @@
+#!/usr/bin/env python3
+"""Convert a PNG or PBM image into a compressed 1-bpp E-INK asset.
+
+The asset is written as a C source and a C header that define a
+cy_eink_asset_t, for Cy_EINK_AssetToFrameBuffer(). See
+MCU_2_Display/eInk_Library/cy_eink_assets.h for the format.
+
+Only the Python standard library is used.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+ASSET_RUN = 0x80
+ASSET_RUN_LONG = 0x40
+ASSET_RUN_WHITE = 0x20
+ASSET_RUN_LENGTH = 0x1F
+ASSET_LITERAL_PIXELS = 7
+ASSET_SHORT_RUN_MAX = ASSET_RUN_LENGTH + 1
+ASSET_LONG_RUN_MAX = ((ASSET_RUN_LENGTH << 8) | 0xFF) + 1
+
+DISPLAY_WIDTH = 264
+DISPLAY_HEIGHT = 176
+
+
+def _paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    if pb <= pc:
+        return b
+    return c
+
+
+def read_png(path):
+    """Return (width, height, rows of luma 0-255) of an 8-bit PNG.
+
+    Transparent pixels are composed over white.
+    """
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('%s: not a PNG file' % path)
+
+    pos = 8
+    idat = b''
+    palette = []
+    alphas = b''
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = \
+                struct.unpack('>IIBBBBB', chunk)
+        elif kind == b'PLTE':
+            palette = [tuple(chunk[i:i + 3]) for i in range(0, length, 3)]
+        elif kind == b'tRNS':
+            alphas = chunk
+        elif kind == b'IDAT':
+            idat += chunk
+        elif kind == b'IEND':
+            break
+
+    if depth != 8 or interlace != 0:
+        raise ValueError('%s: only 8-bit non-interlaced PNG files are supported'
+                         % path)
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(color)
+    if channels is None:
+        raise ValueError('%s: unsupported PNG color type %d' % (path, color))
+
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    prev = bytearray(stride)
+    rows = []
+    pos = 0
+    for _ in range(height):
+        kind = raw[pos]
+        line = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        for i in range(stride):
+            a = line[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif kind == 4:
+                line[i] = (line[i] + _paeth(a, b, c)) & 0xFF
+        prev = line
+
+        luma = []
+        for x in range(width):
+            px = line[x * channels:(x + 1) * channels]
+            alpha = 255
+            if color == 0:
+                value = px[0]
+            elif color == 2:
+                value = (299 * px[0] + 587 * px[1] + 114 * px[2]) // 1000
+            elif color == 3:
+                r, g, b = palette[px[0]]
+                value = (299 * r + 587 * g + 114 * b) // 1000
+                if px[0] < len(alphas):
+                    alpha = alphas[px[0]]
+            elif color == 4:
+                value, alpha = px[0], px[1]
+            else:
+                value = (299 * px[0] + 587 * px[1] + 114 * px[2]) // 1000
+                alpha = px[3]
+            luma.append((value * alpha + 255 * (255 - alpha)) // 255)
+        rows.append(luma)
+    return width, height, rows
+
+
+def read_pbm(path):
+    """Return (width, height, rows of luma 0-255) of a P1 or P4 PBM file."""
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    tokens = []
+    pos = 0
+    while len(tokens) < 3:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b'#':
+            while data[pos:pos + 1] not in (b'\n', b''):
+                pos += 1
+            continue
+        start = pos
+        while not data[pos:pos + 1].isspace():
+            pos += 1
+        tokens.append(data[start:pos])
+    magic, width, height = tokens[0], int(tokens[1]), int(tokens[2])
+
+    rows = []
+    if magic == b'P4':
+        pos += 1
+        stride = (width + 7) // 8
+        # netpbm packs P4 rows most significant bit first; this is the file
+        # format only, the asset literals use the frame buffer bit order
+        for y in range(height):
+            line = data[pos + y * stride:pos + (y + 1) * stride]
+            rows.append([0 if line[x >> 3] & (0x80 >> (x & 7)) else 255
+                         for x in range(width)])
+    elif magic == b'P1':
+        bits = [c for c in data[pos:].decode('ascii') if c in '01']
+        for y in range(height):
+            rows.append([0 if bits[y * width + x] == '1' else 255
+                         for x in range(width)])
+    else:
+        raise ValueError('%s: only P1 and P4 PBM files are supported' % path)
+    return width, height, rows
+
+
+def to_pixels(rows, threshold, invert):
+    """Flatten the rows into pixels, True for white."""
+    return [(value >= threshold) != invert for row in rows for value in row]
+
+
+def compress(pixels):
+    """Code the pixels as runs and 7-pixel literals."""
+    out = bytearray()
+    pos = 0
+    while pos < len(pixels):
+        end = pos
+        while end < len(pixels) and pixels[end] == pixels[pos] \
+                and end - pos < ASSET_LONG_RUN_MAX:
+            end += 1
+        length = end - pos
+
+        # A literal codes 7 pixels in one byte, so shorter runs go in literals
+        if length >= ASSET_LITERAL_PIXELS or end == len(pixels):
+            white = ASSET_RUN_WHITE if pixels[pos] else 0
+            if length <= ASSET_SHORT_RUN_MAX:
+                out.append(ASSET_RUN | white | (length - 1))
+            else:
+                out.append(ASSET_RUN | ASSET_RUN_LONG | white |
+                           ((length - 1) >> 8))
+                out.append((length - 1) & 0xFF)
+            pos = end
+        else:
+            # The leftmost pixel goes in bit 0, as emWin and the frame buffer
+            # keep it (LCDConf.c sets Config.Mirror = 1)
+            literal = 0
+            for i in range(ASSET_LITERAL_PIXELS):
+                if pos + i < len(pixels) and pixels[pos + i]:
+                    literal |= 1 << i
+            out.append(literal)
+            pos += ASSET_LITERAL_PIXELS
+    return bytes(out)
+
+
+def decompress(data, count):
+    """Decode the asset data back into pixels, to check the encoder."""
+    pixels = []
+    pos = 0
+    while pos < len(data) and len(pixels) < count:
+        code = data[pos]
+        pos += 1
+        if code & ASSET_RUN:
+            length = code & ASSET_RUN_LENGTH
+            if code & ASSET_RUN_LONG:
+                length = (length << 8) | data[pos]
+                pos += 1
+            pixels += [bool(code & ASSET_RUN_WHITE)] * (length + 1)
+        else:
+            pixels += [bool(code & (1 << i))
+                       for i in range(ASSET_LITERAL_PIXELS)]
+    return pixels[:count]
+
+
+def write_sources(name, width, height, data, out_dir, source):
+    guard = name.upper() + '_H'
+    header = os.path.join(out_dir, name + '.h')
+    with open(header, 'w') as f:
+        f.write('/* Generated by cy_eink_asset_converter.py from %s */\n\n'
+                % os.path.basename(source))
+        f.write('#ifndef %s\n#define %s\n\n' % (guard, guard))
+        f.write('#include "cy_eink_assets.h"\n\n')
+        f.write('/* %u x %u pixels */\n' % (width, height))
+        f.write('extern cy_eink_asset_t const %s;\n\n' % name)
+        f.write('#endif /* %s */\n' % guard)
+
+    with open(os.path.join(out_dir, name + '.c'), 'w') as f:
+        f.write('/* Generated by cy_eink_asset_converter.py from %s */\n\n'
+                % os.path.basename(source))
+        f.write('#include "%s.h"\n\n' % name)
+        f.write('static uint8_t const %s_data[%u] =\n{\n' % (name, len(data)))
+        for i in range(0, len(data), 12):
+            f.write('    ' + ', '.join('0x%02X' % b for b in data[i:i + 12]) +
+                    ',\n')
+        f.write('};\n\n')
+        f.write('cy_eink_asset_t const %s =\n{\n' % name)
+        f.write('    %u, %u, %u, %s_data\n};\n' % (width, height, len(data),
+                                                   name))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('image', help='PNG (8-bit) or PBM (P1/P4) image')
+    parser.add_argument('name', help='C name of the asset')
+    parser.add_argument('-o', '--out-dir', default='.',
+                        help='directory of the generated files')
+    parser.add_argument('-t', '--threshold', type=int, default=128,
+                        help='luma from which a pixel is white (default 128)')
+    parser.add_argument('-i', '--invert', action='store_true',
+                        help='swap black and white')
+    parser.add_argument('--crop', type=int, nargs=4,
+                        metavar=('X', 'Y', 'WIDTH', 'HEIGHT'),
+                        help='convert only this rectangle of the image')
+    args = parser.parse_args()
+
+    if args.image.lower().endswith('.png'):
+        width, height, rows = read_png(args.image)
+    else:
+        width, height, rows = read_pbm(args.image)
+
+    if args.crop:
+        x, y, width, height = args.crop
+        rows = [row[x:x + width] for row in rows[y:y + height]]
+        height = len(rows)
+        width = len(rows[0]) if rows else 0
+
+    if width > DISPLAY_WIDTH or height > DISPLAY_HEIGHT:
+        print('warning: %u x %u is larger than the display, the asset is '
+              'clipped when drawn' % (width, height), file=sys.stderr)
+
+    pixels = to_pixels(rows, args.threshold, args.invert)
+    data = compress(pixels)
+    if decompress(data, len(pixels)) != pixels:
+        raise AssertionError('asset does not decode back to the image')
+    if len(data) > 0xFFFF:
+        raise ValueError('compressed asset exceeds 65535 bytes')
+
+    write_sources(args.name, width, height, data, args.out_dir, args.image)
+
+    frame = (DISPLAY_WIDTH * DISPLAY_HEIGHT) // 8
+    print('%s: %u x %u pixels, %u bytes (full frame image: %u bytes, '
+          'packed bitmap: %u bytes)' %
+          (args.name, width, height, len(data), frame,
+           ((width + 7) // 8) * height))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,100 @@
+/******************************************************************************
+* File Name: cy_eink_host_benchmark.c
+*
+* Version: 1.10
+*
+* Description: Host program that runs the E-INK benchmark on the SPI capture
+*              and checks every update with the waveform decoder.
+*
+* Hardware Dependency: None (host build)
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* Build with CY_EINK_BENCHMARK defined, see README.md. The program prints the
+* JSON lines of Cy_EINK_BenchmarkRun() and exits with a non-zero status if a
+* decoded image differs from the frame the update should show.
+*******************************************************************************/
+
+/* Header file includes */
+#include <eInk_Library/cy_eink_benchmark.h>
+#include "cy_eink_host_decoder.h"
+#include <stdlib.h>
+
+/* Panel temperature of the benchmark in degree Celsius */
+#define CY_EINK_HOST_BENCH_TEMPERATURE  (int8_t)(20)
+
+/*******************************************************************************
+* Function Name: static bool Cy_EINK_HostCheckUpdate(
+*               cy_eink_frame_t const* prevFrame, cy_eink_frame_t const* newFrame)
+********************************************************************************
+*
+* Summary: Decodes the capture of an update, starting from a panel that shows
+*  the previous frame, and compares the result with the new frame.
+*
+* Parameters:
+*  cy_eink_frame_t const* prevFrame : Frame shown before the update
+*  cy_eink_frame_t const* newFrame  : Frame the update should show
+*
+* Return:
+*  bool : true if the panel shows the new frame
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static bool Cy_EINK_HostCheckUpdate(cy_eink_frame_t const* prevFrame,
+                                    cy_eink_frame_t const* newFrame)
+{
+    cy_eink_decoder_t static decoder;
+    
+    Cy_EINK_DecoderInit(&decoder, PV_EINK_WHITE_PIXEL_BYTE);
+    memcpy(decoder.image, prevFrame, CY_EINK_FRAME_SIZE);
+    Cy_EINK_DecodeCapture(&decoder, NULL, NULL);
+    
+    return((decoder.malformedCount == 0u) &&
+           (memcmp(decoder.image, newFrame, CY_EINK_FRAME_SIZE) == 0));
+}
+
+int main(void)
+{
+    CY_EINK_InitDriver();
+    if (!Cy_EINK_Start(CY_EINK_HOST_BENCH_TEMPERATURE))
+    {
+        return(EXIT_FAILURE);
+    }
+    
+    return(Cy_EINK_BenchmarkRun(Cy_EINK_HostCheckUpdate) ? EXIT_SUCCESS : 
+                                                           EXIT_FAILURE);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,846 @@
+/******************************************************************************
+* File Name: cy_eink_host_capture.c
+*
+* Version: 1.10
+*
+* Description: This file implements the PSoC interface of the E-INK library on
+*              a host, recording the SPI transactions on a virtual clock.
+*
+* Hardware Dependency: None (host build)
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* This file provides the functions of eInk_Library/cy_eink_psoc_interface.h for
+* a host build of the E-INK library.
+*
+* Nothing waits: the virtual clock advances by the SPI byte time for each byte 
+* sent and by the requested time for each delay, so the driver timing loops run
+* their usual number of passes in no time. The BUSY pin is never asserted and
+* the register reads return the replies of a healthy display driver, which can
+* be changed with Cy_EINK_CaptureSetReadReply() to exercise the error paths.
+*******************************************************************************/
+
+/* clock_gettime() of the POSIX hosts */
+#define _POSIX_C_SOURCE 199309L
+
+/* Header file includes */
+#include "cy_eink_host_capture.h"
+#include <eInk_Library/pervasive_eink_configuration.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+/* Initial number of records and bytes of the capture log */
+#define CY_EINK_CAPTURE_INITIAL_RECORDS (uint32_t)(1024u)
+#define CY_EINK_CAPTURE_INITIAL_BYTES   (uint32_t)(65536u)
+
+/* Number of register addresses of the display driver */
+#define CY_EINK_CAPTURE_REGISTER_COUNT  (uint16_t)(256u)
+
+/* Driver ID read back by a healthy display driver */
+#define CY_EINK_CAPTURE_DRIVER_ID       (uint8_t)(0x12u)
+
+/* Breakage and DC level bits read back by a healthy display driver */
+#define CY_EINK_CAPTURE_DRIVER_STATUS   (uint8_t)(PV_EINK_TEST_BREAKAGE_MASK | \
+                                                  PV_EINK_DC_LEVEL_MASK)
+
+/* Nanoseconds per microsecond and per millisecond */
+#define CY_EINK_CAPTURE_NS_PER_US       (uint64_t)(1000u)
+#define CY_EINK_CAPTURE_NS_PER_MS       (uint64_t)(1000000u)
+
+/* Virtual time in nS, and its value at the last Cy_EINK_TimerInit() */
+uint64_t static                 virtualTime;
+uint64_t static                 timerStart;
+
+/* Capture records and the log of the transaction bytes */
+cy_eink_capture_record_t static* records;
+uint32_t static                 recordCount;
+uint32_t static                 recordCapacity;
+uint8_t static*                 byteLog;
+uint32_t static                 byteCount;
+uint32_t static                 byteCapacity;
+
+/* Number of CS-framed transactions recorded */
+uint32_t static                 transactionCount;
+
+/* True while the chip select is LOW */
+bool static                     transactionOpen;
+
+/* Levels of the display pins */
+uint8_t static                  pinLevel[CY_EINK_HOST_PIN_COUNT];
+
+/* Register address of the last register index transaction */
+uint8_t static                  registerIndex;
+
+/* Replies of the display driver to register reads */
+uint8_t static                  readReply[CY_EINK_CAPTURE_REGISTER_COUNT];
+bool static                     readRepliesValid;
+
+/*******************************************************************************
+* Function Name: static void* Cy_EINK_CaptureGrow(void* buffer, 
+*                                       uint32_t* capacity, uint32_t initial,
+*                                       size_t elementSize, uint32_t required)
+********************************************************************************
+*
+* Summary: Grows a capture buffer so that it holds the required number of
+*  elements. The capture is a development tool, so running out of memory ends
+*  the program.
+*
+* Parameters:
+*  void* buffer       : Buffer to grow, or NULL
+*  uint32_t* capacity : Number of elements of the buffer, updated
+*  uint32_t initial   : Number of elements of a new buffer
+*  size_t elementSize : Size of an element in bytes
+*  uint32_t required  : Number of elements needed
+*
+* Return:
+*  void*: The grown buffer
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static void* Cy_EINK_CaptureGrow(void* buffer, uint32_t* capacity, 
+                                 uint32_t initial, size_t elementSize,
+                                 uint32_t required)
+{
+    uint32_t    newCapacity = (*capacity == 0u) ? initial : *capacity;
+    
+    if (required <= *capacity)
+    {
+        return buffer;
+    }
+    while (newCapacity < required)
+    {
+        newCapacity *= 2u;
+    }
+    buffer = realloc(buffer, newCapacity * elementSize);
+    if (buffer == NULL)
+    {
+        fprintf(stderr, "E-INK capture: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = newCapacity;
+    return buffer;
+}
+
+/*******************************************************************************
+* Function Name: static void Cy_EINK_CaptureAddRecord(
+*                                       cy_eink_capture_event_t event)
+********************************************************************************
+*
+* Summary: Appends a record at the current virtual time.
+*
+* Parameters:
+*  cy_eink_capture_event_t event : Type of the record
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static void Cy_EINK_CaptureAddRecord(cy_eink_capture_event_t event)
+{
+    records = Cy_EINK_CaptureGrow(records, &recordCapacity, 
+                                  CY_EINK_CAPTURE_INITIAL_RECORDS,
+                                  sizeof(cy_eink_capture_record_t),
+                                  recordCount + 1u);
+    records[recordCount].event = event;
+    records[recordCount].timestamp = Cy_EINK_CaptureTime();
+    records[recordCount].offset = byteCount;
+    records[recordCount].length = 0u;
+    recordCount++;
+}
+
+/*******************************************************************************
+* Function Name: static void Cy_EINK_CaptureByte(uint8_t data)
+********************************************************************************
+*
+* Summary: Clocks a byte out of the SPI. The byte is added to the open 
+*  transaction; a byte sent with the chip select HIGH is ignored by the display
+*  and only takes time.
+*
+* Parameters:
+*  uint8_t data : Byte sent
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static void Cy_EINK_CaptureByte(uint8_t data)
+{
+    virtualTime += CY_EINK_HOST_SPI_BYTE_TIME;
+    if (!transactionOpen)
+    {
+        return;
+    }
+    byteLog = Cy_EINK_CaptureGrow(byteLog, &byteCapacity, 
+                                  CY_EINK_CAPTURE_INITIAL_BYTES, 
+                                  sizeof(uint8_t), byteCount + 1u);
+    byteLog[byteCount++] = data;
+    records[recordCount - 1u].length++;
+}
+
+/*******************************************************************************
+* Function Name: static void Cy_EINK_CaptureSetDefaultReplies(void)
+********************************************************************************
+*
+* Summary: Sets the register read replies of a healthy display driver.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static void Cy_EINK_CaptureSetDefaultReplies(void)
+{
+    memset(readReply, 0, sizeof(readReply));
+    readReply[PV_EINK_DRIVER_ID_COMMAND_INDEX] = CY_EINK_CAPTURE_DRIVER_ID;
+    readReply[PV_EINK_TEST_BREAKAGE_COMMAND_INDEX] = CY_EINK_CAPTURE_DRIVER_STATUS;
+    readRepliesValid = true;
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_CaptureReset(void)
+********************************************************************************
+*
+* Summary: Clears the capture log and restarts the virtual clock. The pin 
+*  levels and the register read replies are kept.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  Pointers returned by Cy_EINK_CaptureRecord() and Cy_EINK_CaptureBytes() 
+*  become invalid.
+*
+*******************************************************************************/
+void Cy_EINK_CaptureReset(void)
+{
+    free(records);
+    free(byteLog);
+    records = NULL;
+    byteLog = NULL;
+    recordCount = 0u;
+    recordCapacity = 0u;
+    byteCount = 0u;
+    byteCapacity = 0u;
+    transactionCount = 0u;
+    transactionOpen = false;
+    virtualTime = 0u;
+    timerStart = 0u;
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_CaptureSetReadReply(uint8_t regIndex, 
+*                                                 uint8_t value)
+********************************************************************************
+*
+* Summary: Sets the value read back from a register of the display driver.
+*
+* Parameters:
+*  uint8_t regIndex : Register address
+*  uint8_t value    : Value returned by the reads of the register
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_CaptureSetReadReply(uint8_t regIndex, uint8_t value)
+{
+    if (!readRepliesValid)
+    {
+        Cy_EINK_CaptureSetDefaultReplies();
+    }
+    readReply[regIndex] = value;
+}
+
+/*******************************************************************************
+* Function Name: uint32_t Cy_EINK_CaptureTime(void)
+********************************************************************************
+*
+* Summary: Returns the virtual time since the last Cy_EINK_CaptureReset().
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t: Virtual time in uS
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+uint32_t Cy_EINK_CaptureTime(void)
+{
+    return (uint32_t)(virtualTime / CY_EINK_CAPTURE_NS_PER_US);
+}
+
+/*******************************************************************************
+* Function Name: uint32_t Cy_EINK_CaptureRecordCount(void)
+********************************************************************************
+*
+* Summary: Returns the number of records of the capture, transactions and stage
+*  ends included.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t: Number of records
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+uint32_t Cy_EINK_CaptureRecordCount(void)
+{
+    return recordCount;
+}
+
+/*******************************************************************************
+* Function Name: cy_eink_capture_record_t const* Cy_EINK_CaptureRecord(
+*                                                       uint32_t index)
+********************************************************************************
+*
+* Summary: Returns a record of the capture.
+*
+* Parameters:
+*  uint32_t index : Index of the record, in the order of recording
+*
+* Return:
+*  cy_eink_capture_record_t const*: The record, or NULL if the index is out of
+*                                   range
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+cy_eink_capture_record_t const* Cy_EINK_CaptureRecord(uint32_t index)
+{
+    return (index < recordCount) ? &records[index] : NULL;
+}
+
+/*******************************************************************************
+* Function Name: uint8_t const* Cy_EINK_CaptureBytes(
+*                                   cy_eink_capture_record_t const* record)
+********************************************************************************
+*
+* Summary: Returns the bytes of a transaction record.
+*
+* Parameters:
+*  cy_eink_capture_record_t const* record : Record of the capture
+*
+* Return:
+*  uint8_t const*: record->length bytes, in the order sent
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+uint8_t const* Cy_EINK_CaptureBytes(cy_eink_capture_record_t const* record)
+{
+    return &byteLog[record->offset];
+}
+
+/*******************************************************************************
+* Function Name: uint32_t Cy_EINK_CaptureByteCount(void)
+********************************************************************************
+*
+* Summary: Returns the number of bytes sent inside CS-framed transactions.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t: Number of bytes
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+uint32_t Cy_EINK_CaptureByteCount(void)
+{
+    return byteCount;
+}
+
+/*******************************************************************************
+* Function Name: uint32_t Cy_EINK_CaptureTransactionCount(void)
+********************************************************************************
+*
+* Summary: Returns the number of CS-framed transactions.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t: Number of transactions
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+uint32_t Cy_EINK_CaptureTransactionCount(void)
+{
+    return transactionCount;
+}
+
+/*******************************************************************************
+* Function Name: uint8_t Cy_EINK_CapturePinLevel(cy_eink_host_pin_t pin)
+********************************************************************************
+*
+* Summary: Returns the level of a display pin.
+*
+* Parameters:
+*  cy_eink_host_pin_t pin : Display pin
+*
+* Return:
+*  uint8_t: CY_EINK_PIN_LOW or CY_EINK_PIN_HIGH
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+uint8_t Cy_EINK_CapturePinLevel(cy_eink_host_pin_t pin)
+{
+    return pinLevel[pin];
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_HostWritePin(cy_eink_host_pin_t pin, 
+*                                          uint8_t level)
+********************************************************************************
+*
+* Summary: Sets a display pin. A falling edge of the chip select opens a 
+*  transaction and a rising edge closes it.
+*
+* Parameters:
+*  cy_eink_host_pin_t pin : Display pin
+*  uint8_t level          : CY_EINK_PIN_LOW or CY_EINK_PIN_HIGH
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_HostWritePin(cy_eink_host_pin_t pin, uint8_t level)
+{
+    pinLevel[pin] = level;
+    if (pin != CY_EINK_HOST_PIN_CS)
+    {
+        return;
+    }
+    
+    if ((level == CY_EINK_PIN_LOW) && !transactionOpen)
+    {
+        virtualTime += CY_EINK_HOST_CS_GAP_TIME;
+        Cy_EINK_CaptureAddRecord(CY_EINK_CAPTURE_TRANSACTION);
+        transactionOpen = true;
+    }
+    else if ((level == CY_EINK_PIN_HIGH) && transactionOpen)
+    {
+        cy_eink_capture_record_t* record = &records[recordCount - 1u];
+        
+        transactionOpen = false;
+        
+        /* A transaction without a byte is no register access */
+        if (record->length == 0u)
+        {
+            recordCount--;
+            return;
+        }
+        transactionCount++;
+        
+        /* Remember the register addressed by a register index transaction */
+        if ((record->length >= 2u) && 
+            (byteLog[record->offset] == PV_EINK_REG_INDEX_HEADER))
+        {
+            registerIndex = byteLog[record->offset + 1u];
+        }
+    }
+    else
+    {
+    }
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_HostDelay(uint32_t delay)
+********************************************************************************
+*
+* Summary: Advances the virtual clock by the given number of milliseconds.
+*
+* Parameters:
+*  uint32_t delay : Delay in mS
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_HostDelay(uint32_t delay)
+{
+    virtualTime += (uint64_t)delay * CY_EINK_CAPTURE_NS_PER_MS;
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_StartTimer(void)
+********************************************************************************
+*
+* Summary: The virtual clock always runs.
+*
+*******************************************************************************/
+bool Cy_EINK_StartTimer(void)
+{
+    return(true);
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_TimerInit(void)
+********************************************************************************
+*
+* Summary: Restarts the E-INK timer count from zero.
+*
+*******************************************************************************/
+void Cy_EINK_TimerInit(void)
+{
+    timerStart = virtualTime;
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_TimerStop(void)
+********************************************************************************
+*
+* Summary: The driver stops the timer at the end of each update stage, which is
+*  recorded in the capture.
+*
+*******************************************************************************/
+void Cy_EINK_TimerStop(void)
+{
+    Cy_EINK_CaptureAddRecord(CY_EINK_CAPTURE_STAGE_END);
+}
+
+/*******************************************************************************
+* Function Name: uint32_t Cy_EINK_GetTimeTick(void)
+********************************************************************************
+*
+* Summary: Returns the virtual time since Cy_EINK_TimerInit() in timer ticks 
+*  (uS).
+*
+*******************************************************************************/
+uint32_t Cy_EINK_GetTimeTick(void)
+{
+    return (uint32_t)((virtualTime - timerStart) / CY_EINK_CAPTURE_NS_PER_US);
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_DelayUs(uint32_t delay)
+********************************************************************************
+*
+* Summary: Advances the virtual clock by the given number of microseconds.
+*
+*******************************************************************************/
+void Cy_EINK_DelayUs(uint32_t delay)
+{
+    virtualTime += (uint64_t)delay * CY_EINK_CAPTURE_NS_PER_US;
+}
+
+/*******************************************************************************
+* Function Name: void CY_EINK_InitDriver(void)
+********************************************************************************
+*
+* Summary: Sets the display pins to their levels after a PSoC reset.
+*
+*******************************************************************************/
+void CY_EINK_InitDriver(void)
+{
+    memset(pinLevel, CY_EINK_PIN_LOW, sizeof(pinLevel));
+    pinLevel[CY_EINK_HOST_PIN_CS] = CY_EINK_PIN_HIGH;
+    if (!readRepliesValid)
+    {
+        Cy_EINK_CaptureSetDefaultReplies();
+    }
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_InitSPI(void)
+********************************************************************************
+*
+* Summary: Leaves the chip select HIGH, as the PSoC SPI initialization does.
+*
+*******************************************************************************/
+void Cy_EINK_InitSPI(void)
+{
+    CY_EINK_CsHigh;
+    if (!readRepliesValid)
+    {
+        Cy_EINK_CaptureSetDefaultReplies();
+    }
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_AttachSPI(void)
+********************************************************************************
+*
+* Summary: The captured SPI has no pins to attach.
+*
+*******************************************************************************/
+void Cy_EINK_AttachSPI(void)
+{
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_DetachSPI(void)
+********************************************************************************
+*
+* Summary: The captured SPI has no pins to detach.
+*
+*******************************************************************************/
+void Cy_EINK_DetachSPI(void)
+{
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_WriteSPI(uint8_t data)
+********************************************************************************
+*
+* Summary: Sends a byte into the open transaction.
+*
+*******************************************************************************/
+void Cy_EINK_WriteSPI(uint8_t data)
+{
+    Cy_EINK_CaptureByte(data);
+}
+
+/*******************************************************************************
+* Function Name: int Cy_EINK_WriteSPIBuffer(uint8_t* data, uint16 dataLength)
+********************************************************************************
+*
+* Summary: Sends multiple bytes into the open transaction.
+*
+*******************************************************************************/
+int Cy_EINK_WriteSPIBuffer(uint8_t* data, uint16 dataLength)
+{
+    uint16_t    i;
+    
+    for (i = 0u; i < dataLength; i++)
+    {
+        Cy_EINK_CaptureByte(data[i]);
+    }
+    return dataLength;
+}
+
+/*******************************************************************************
+* Function Name: uint8_t Cy_EINK_ReadSPI(void)
+********************************************************************************
+*
+* Summary: Clocks in a byte by sending a dummy byte.
+*
+*******************************************************************************/
+uint8_t Cy_EINK_ReadSPI(void)
+{
+    return Cy_EINK_WriteReadSPI(0u);
+}
+
+/*******************************************************************************
+* Function Name: uint8_t Cy_EINK_WriteReadSPI(uint8_t data)
+********************************************************************************
+*
+* Summary: Sends a byte and returns the reply of the display driver: the value
+*  of the register addressed by the last register index transaction when the 
+*  byte follows a data read header, zero otherwise.
+*
+*******************************************************************************/
+uint8_t Cy_EINK_WriteReadSPI(uint8_t data)
+{
+    bool    dataRead = transactionOpen && 
+                       (records[recordCount - 1u].length > 0u) &&
+                       (byteLog[records[recordCount - 1u].offset] == 
+                        PV_EINK_REG_DATA_READ);
+    
+    Cy_EINK_CaptureByte(data);
+    return dataRead ? readReply[registerIndex] : 0u;
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_IsBusy(void)
+********************************************************************************
+*
+* Summary: The emulated display driver is never busy.
+*
+*******************************************************************************/
+bool Cy_EINK_IsBusy(void)
+{
+    return false;
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_WaitWhileBusy(uint32_t timeout)
+********************************************************************************
+*
+* Summary: The emulated display driver is never busy.
+*
+*******************************************************************************/
+bool Cy_EINK_WaitWhileBusy(uint32_t timeout)
+{
+    (void)timeout;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_QueueSPIBuffer(uint8_t* header, 
+*                       uint8_t headerLength, uint8_t* data, uint16_t dataLength)
+********************************************************************************
+*
+* Summary: Sends a CS-framed transaction at once. The transactions are recorded
+*  in the order the driver queues them, which is the order the PSoC SPI sends
+*  them in.
+*
+*******************************************************************************/
+bool Cy_EINK_QueueSPIBuffer(uint8_t* header, uint8_t headerLength,
+                            uint8_t* data, uint16_t dataLength)
+{
+    uint16_t    i;
+    
+    CY_EINK_CsLow;
+    for (i = 0u; i < headerLength; i++)
+    {
+        Cy_EINK_CaptureByte(header[i]);
+    }
+    for (i = 0u; i < dataLength; i++)
+    {
+        Cy_EINK_CaptureByte(data[i]);
+    }
+    CY_EINK_CsHigh;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: bool Cy_EINK_WaitSPIQueue(uint8_t maxPending)
+********************************************************************************
+*
+* Summary: The queued transactions are sent at once, so the queue is always 
+*  empty.
+*
+*******************************************************************************/
+bool Cy_EINK_WaitSPIQueue(uint8_t maxPending)
+{
+    (void)maxPending;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: uint32_t Cy_EINK_GetCycleCount(void)
+********************************************************************************
+*
+* Summary: Returns the time stamp counter of an x86 host, or the monotonic 
+*  clock in nS on other hosts. Unlike the E-INK timer, this measures the real
+*  time the host CPU spends in the library.
+*
+*******************************************************************************/
+uint32_t Cy_EINK_GetCycleCount(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_CountedCsLow(void)
+********************************************************************************
+*
+* Summary: Pulls the chip select LOW. The capture counts the transactions 
+*  itself.
+*
+*******************************************************************************/
+void Cy_EINK_CountedCsLow(void)
+{
+    CY_EINK_CsLow;
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_ResetSPICounters(void)
+********************************************************************************
+*
+* Summary: Clears the capture, which holds the SPI counters.
+*
+*******************************************************************************/
+void Cy_EINK_ResetSPICounters(void)
+{
+    Cy_EINK_CaptureReset();
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_GetSPICounters(uint32_t* bytes, 
+*                                            uint32_t* transactions)
+********************************************************************************
+*
+* Summary: Reads the number of bytes and CS-framed transactions captured.
+*
+*******************************************************************************/
+void Cy_EINK_GetSPICounters(uint32_t* bytes, uint32_t* transactions)
+{
+    *bytes = Cy_EINK_CaptureByteCount();
+    *transactions = Cy_EINK_CaptureTransactionCount();
+}
+
+/* [] END OF FILE */
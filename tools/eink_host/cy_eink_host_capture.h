@@ -0,0 +1,94 @@
+/******************************************************************************
+* File Name: cy_eink_host_capture.h
+*
+* Version: 1.10
+*
+* Description: This file contains function declarations and macro definitions
+*              provided by the cy_eink_host_capture.c file.
+*
+* Hardware Dependency: None (host build)
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* The SPI capture records every CS-framed transaction the E-INK library sends,
+* with the virtual time at which the chip select was pulled low, and marks the
+* end of each update stage. Cy_EINK_DecodeCapture() of cy_eink_host_decoder.h
+* replays the records into a panel image.
+*******************************************************************************/
+/* Include Guard */
+#ifndef CY_EINK_HOST_CAPTURE_H
+#define CY_EINK_HOST_CAPTURE_H
+
+/* Header file includes */
+#include <eInk_Library/cy_eink_psoc_interface.h>
+
+/* Time in nS to clock one byte out of the 20 MHz SPI */
+#define CY_EINK_HOST_SPI_BYTE_TIME      (uint32_t)(400u)
+
+/* Time in nS between two CS-framed transactions */
+#define CY_EINK_HOST_CS_GAP_TIME        (uint32_t)(1000u)
+
+/* Type of a capture record */
+typedef enum
+{
+    /* Bytes sent between a falling and a rising edge of the chip select */
+    CY_EINK_CAPTURE_TRANSACTION,
+    /* End of an update stage, recorded when the driver stops its timer */
+    CY_EINK_CAPTURE_STAGE_END
+}   cy_eink_capture_event_t;
+
+/* Capture record */
+typedef struct
+{
+    cy_eink_capture_event_t event;
+    /* Virtual time in uS of the chip select falling edge or the stage end */
+    uint32_t                timestamp;
+    /* Position of the first byte in the capture byte log */
+    uint32_t                offset;
+    /* Number of bytes of the transaction */
+    uint16_t                length;
+}   cy_eink_capture_record_t;
+
+/* Functions that control and read the capture */
+void            Cy_EINK_CaptureReset(void);
+void            Cy_EINK_CaptureSetReadReply(uint8_t regIndex, uint8_t value);
+uint32_t        Cy_EINK_CaptureTime(void);
+uint32_t        Cy_EINK_CaptureRecordCount(void);
+cy_eink_capture_record_t const* Cy_EINK_CaptureRecord(uint32_t index);
+uint8_t const*  Cy_EINK_CaptureBytes(cy_eink_capture_record_t const* record);
+uint32_t        Cy_EINK_CaptureByteCount(void);
+uint32_t        Cy_EINK_CaptureTransactionCount(void);
+uint8_t         Cy_EINK_CapturePinLevel(cy_eink_host_pin_t pin);
+
+#endif /* CY_EINK_HOST_CAPTURE_H */
+/* [] END OF FILE */
@@ -0,0 +1,304 @@
+/******************************************************************************
+* File Name: cy_eink_host_decoder.c
+*
+* Version: 1.10
+*
+* Description: This file replays a SPI capture of the E-INK library into the
+*              image shown by the panel.
+*
+* Hardware Dependency: None (host build)
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* The decoder follows the register protocol of the display driver: a register
+* index transaction (0x70, address) selects the register and a data write 
+* transaction (0x72, data...) writes it. A data write of the pixel data 
+* register is kept as the current data line and applied when Output Enable is
+* written. The line layout is the one of the driver document, Section 5.1: a 
+* dummy byte, the even bytes from right to left, the scan bytes from the bottom
+* line up and the odd bytes from left to right.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cy_eink_host_decoder.h"
+#include <string.h>
+
+/* Offsets of the byte groups of a data line */
+#define CY_EINK_DECODE_EVEN_OFFSET  (uint8_t)(1u)
+#define CY_EINK_DECODE_SCAN_OFFSET  (uint8_t)(CY_EINK_DECODE_EVEN_OFFSET + \
+                                              PV_EINK_HORIZONTAL_SIZE)
+#define CY_EINK_DECODE_ODD_OFFSET   (uint8_t)(CY_EINK_DECODE_SCAN_OFFSET + \
+                                              PV_EINK_SCAN_LINE_SIZE)
+
+/* Mask of the 2-bit code of a pixel or a scan line */
+#define CY_EINK_DECODE_CODE_MASK    (uint8_t)(0x03u)
+
+/* Bits of the image byte driven by the codes of an odd byte and of an even 
+   byte, from the least significant code up */
+uint8_t const   oddPixelBits[PV_EINK_SCAN_TABLE_SIZE] = 
+                {PV_EINK_ODD_MASK_D, PV_EINK_ODD_MASK_C, 
+                 PV_EINK_ODD_MASK_B, PV_EINK_ODD_MASK_A};
+uint8_t const   evenPixelBits[PV_EINK_SCAN_TABLE_SIZE] = 
+                {PV_EINK_EVEN_MASK_A, PV_EINK_EVEN_MASK_B, 
+                 PV_EINK_EVEN_MASK_C, PV_EINK_EVEN_MASK_D};
+
+/*******************************************************************************
+* Function Name: static void Cy_EINK_DecodePixels(uint8_t* imageByte, 
+*                                       uint8_t codes, uint8_t const* bits)
+********************************************************************************
+*
+* Summary: Applies the four pixel codes of an odd or an even data byte to an 
+*  image byte.
+*
+* Parameters:
+*  uint8_t* imageByte : Image byte of the pixels
+*  uint8_t codes      : Odd or even data byte
+*  uint8_t const* bits: Image bits driven by the codes
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static void Cy_EINK_DecodePixels(uint8_t* imageByte, uint8_t codes, 
+                                 uint8_t const* bits)
+{
+    uint8_t     i;
+    uint8_t     code;
+    
+    for (i = 0u; i < PV_EINK_SCAN_TABLE_SIZE; i++)
+    {
+        code = (uint8_t)((codes >> (i * PV_EINK_PIXEL_SIZE)) & 
+                         CY_EINK_DECODE_CODE_MASK);
+        if (code == PV_EINK_WHITE0)
+        {
+            *imageByte |= bits[i];
+        }
+        else if (code == PV_EINK_BLACK0)
+        {
+            *imageByte &= (uint8_t)~bits[i];
+        }
+        else
+        {
+            /* Nothing codes leave the pixel as it is */
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: static void Cy_EINK_DecodeLatch(cy_eink_decoder_t* decoder)
+********************************************************************************
+*
+* Summary: Applies the current data line to every line it scans.
+*
+* Parameters:
+*  cy_eink_decoder_t* decoder : Decoder state
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+static void Cy_EINK_DecodeLatch(cy_eink_decoder_t* decoder)
+{
+    uint8_t const*  scan = &decoder->line[CY_EINK_DECODE_SCAN_OFFSET];
+    uint8_t const*  even = &decoder->line[CY_EINK_DECODE_EVEN_OFFSET];
+    uint8_t const*  odd = &decoder->line[CY_EINK_DECODE_ODD_OFFSET];
+    uint8_t*        imageLine;
+    uint16_t        scanLine;
+    uint16_t        x;
+    
+    decoder->latchCount++;
+    
+    for (scanLine = 0u; scanLine < PV_EINK_VERTICAL_SIZE; scanLine++)
+    {
+        /* Scan codes run from the most significant bits of each scan byte */
+        if (((scan[scanLine >> PV_EINK_PIXEL_SIZE] >> 
+              ((PV_EINK_SCAN_TABLE_SIZE - 1u - (scanLine % PV_EINK_SCAN_TABLE_SIZE)) *
+               PV_EINK_PIXEL_SIZE)) & CY_EINK_DECODE_CODE_MASK) != 
+            CY_EINK_DECODE_CODE_MASK)
+        {
+            continue;
+        }
+        
+        /* Scan lines are numbered from the bottom of the image */
+        imageLine = &decoder->image[(PV_EINK_VERTICAL_SIZE - 1u - scanLine) * 
+                                    PV_EINK_HORIZONTAL_SIZE];
+        decoder->scanCount++;
+        
+        for (x = 0u; x < PV_EINK_HORIZONTAL_SIZE; x++)
+        {
+            Cy_EINK_DecodePixels(&imageLine[x], odd[x], oddPixelBits);
+            Cy_EINK_DecodePixels(&imageLine[x], 
+                                 even[PV_EINK_HORIZONTAL_SIZE - 1u - x], 
+                                 evenPixelBits);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_DecoderInit(cy_eink_decoder_t* decoder, 
+*                                         uint8_t background)
+********************************************************************************
+*
+* Summary: Starts a decoder on a uniform panel.
+*
+* Parameters:
+*  cy_eink_decoder_t* decoder : Decoder state
+*  uint8_t background         : PV_EINK_WHITE_PIXEL_BYTE or 
+*                               PV_EINK_BLACK_PIXEL_BYTE
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_DecoderInit(cy_eink_decoder_t* decoder, uint8_t background)
+{
+    memset(decoder, 0, sizeof(cy_eink_decoder_t));
+    memset(decoder->image, background, sizeof(decoder->image));
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_DecodeRecord(cy_eink_decoder_t* decoder, 
+*                                   cy_eink_capture_record_t const* record)
+********************************************************************************
+*
+* Summary: Applies a capture record to the decoded panel.
+*
+* Parameters:
+*  cy_eink_decoder_t* decoder              : Decoder state
+*  cy_eink_capture_record_t const* record  : Record of the capture
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_DecodeRecord(cy_eink_decoder_t* decoder, 
+                          cy_eink_capture_record_t const* record)
+{
+    uint8_t const*  bytes;
+    
+    if (record->event == CY_EINK_CAPTURE_STAGE_END)
+    {
+        decoder->stageCount++;
+        return;
+    }
+    
+    bytes = Cy_EINK_CaptureBytes(record);
+    
+    /* Register index transaction */
+    if ((bytes[0] == PV_EINK_REG_INDEX_HEADER) && (record->length >= 2u))
+    {
+        decoder->registerIndex = bytes[1];
+    }
+    /* Data write transaction */
+    else if ((bytes[0] == PV_EINK_REG_DATA_WRITE) && (record->length >= 2u))
+    {
+        if (decoder->registerIndex == PV_EINK_PIXEL_DATA_COMMAND_INDEX)
+        {
+            if (record->length == (PV_EINK_DATA_LINE_SIZE + 1u))
+            {
+                memcpy(decoder->line, &bytes[1], PV_EINK_DATA_LINE_SIZE);
+                decoder->lineValid = true;
+            }
+            else
+            {
+                decoder->lineValid = false;
+                decoder->malformedCount++;
+            }
+        }
+        else if ((decoder->registerIndex == PV_EINK_ENABLE_OE_COMMAND_INDEX) &&
+                 (bytes[1] == PV_EINK_ENABLE_OE_COMMAND_DATA) &&
+                 decoder->lineValid)
+        {
+            Cy_EINK_DecodeLatch(decoder);
+        }
+        else
+        {
+        }
+    }
+    else
+    {
+        /* Register reads do not change the panel */
+    }
+}
+
+/*******************************************************************************
+* Function Name: void Cy_EINK_DecodeCapture(cy_eink_decoder_t* decoder,
+*                           cy_eink_stage_callback_t callback, void* context)
+********************************************************************************
+*
+* Summary: Replays the whole capture, calling back at the end of each stage 
+*  with the image the panel shows.
+*
+* Parameters:
+*  cy_eink_decoder_t* decoder        : Decoder state
+*  cy_eink_stage_callback_t callback : Stage end callback, or NULL
+*  void* context                     : Passed to the callback
+*
+* Return:
+*  None
+*
+* Side Effects:
+*  None
+*
+*******************************************************************************/
+void Cy_EINK_DecodeCapture(cy_eink_decoder_t* decoder, 
+                           cy_eink_stage_callback_t callback, void* context)
+{
+    uint32_t                        i;
+    cy_eink_capture_record_t const* record;
+    
+    for (i = 0u; i < Cy_EINK_CaptureRecordCount(); i++)
+    {
+        record = Cy_EINK_CaptureRecord(i);
+        Cy_EINK_DecodeRecord(decoder, record);
+        
+        if ((record->event == CY_EINK_CAPTURE_STAGE_END) && (callback != NULL))
+        {
+            callback(decoder, record, context);
+        }
+    }
+}
+
+/* [] END OF FILE */
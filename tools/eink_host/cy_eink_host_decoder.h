@@ -0,0 +1,88 @@
+/******************************************************************************
+* File Name: cy_eink_host_decoder.h
+*
+* Version: 1.10
+*
+* Description: This file contains function declarations and macro definitions
+*              provided by the cy_eink_host_decoder.c file.
+*
+* Hardware Dependency: None (host build)
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* The waveform decoder replays a SPI capture into the image the panel shows. 
+* Each data line latched with Output Enable drives the pixels of its scanned
+* line: a white or black code sets the pixel, a nothing code leaves it. The 
+* image is in the frame buffer format of the E-INK library, a set bit being a
+* white pixel.
+*******************************************************************************/
+/* Include Guard */
+#ifndef CY_EINK_HOST_DECODER_H
+#define CY_EINK_HOST_DECODER_H
+
+/* Header file includes */
+#include "cy_eink_host_capture.h"
+#include <eInk_Library/pervasive_eink_configuration.h>
+
+/* State of the decoded panel */
+typedef struct
+{
+    /* Image shown by the panel */
+    uint8_t     image[PV_EINK_IMAGE_SIZE];
+    /* Last data line written and whether it waits for Output Enable */
+    uint8_t     line[PV_EINK_DATA_LINE_SIZE];
+    bool        lineValid;
+    /* Register addressed by the last register index transaction */
+    uint8_t     registerIndex;
+    /* Number of stages, latched data lines and scanned lines decoded */
+    uint32_t    stageCount;
+    uint32_t    latchCount;
+    uint32_t    scanCount;
+    /* Number of data writes that were not a complete data line */
+    uint32_t    malformedCount;
+}   cy_eink_decoder_t;
+
+/* Function called with the panel image at the end of each update stage */
+typedef void (*cy_eink_stage_callback_t)(cy_eink_decoder_t const* decoder,
+                                         cy_eink_capture_record_t const* record,
+                                         void* context);
+
+/* Functions of the waveform decoder */
+void    Cy_EINK_DecoderInit(cy_eink_decoder_t* decoder, uint8_t background);
+void    Cy_EINK_DecodeRecord(cy_eink_decoder_t* decoder, 
+                             cy_eink_capture_record_t const* record);
+void    Cy_EINK_DecodeCapture(cy_eink_decoder_t* decoder, 
+                              cy_eink_stage_callback_t callback, void* context);
+
+#endif /* CY_EINK_HOST_DECODER_H */
+/* [] END OF FILE */
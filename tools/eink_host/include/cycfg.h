@@ -0,0 +1,15 @@
+/******************************************************************************
+* File Name: cycfg.h
+*
+* Description: Empty stand-in for the generated device configuration header,
+*              which the E-INK library includes but does not use on a host.
+*
+*******************************************************************************/
+#ifndef CYCFG_H
+#define CYCFG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#endif /* CYCFG_H */
+/* [] END OF FILE */
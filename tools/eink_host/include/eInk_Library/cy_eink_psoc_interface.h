@@ -0,0 +1,174 @@
+/******************************************************************************
+* File Name: cy_eink_psoc_interface.h
+*
+* Version: 1.10
+*
+* Description: Host replacement of the PSoC interface of the E-INK library. It
+*              routes the SPI, GPIO and timer accesses of the driver to the SPI
+*              capture of cy_eink_host_capture.c.
+*
+* Hardware Dependency: None (host build)
+*
+*******************************************************************************
+* Copyright (2019), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+********************************************************************************/
+/******************************************************************************
+* This header takes the place of eInk_Library/cy_eink_psoc_interface.h when the
+* E-INK library is built on a host. It is found first on the include path, so
+* the library sources are compiled unchanged.
+*
+* The functions are the ones of the PSoC interface, implemented by 
+* cy_eink_host_capture.c on a virtual clock. Pin writes, SPI transactions and
+* delays advance that clock instead of waiting. See tools/eink_host/README.md.
+*******************************************************************************/
+
+/* Include Guard */
+#ifndef CY_EINK_INTERFACE_H
+#define CY_EINK_INTERFACE_H
+
+/* Header file includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Integer types provided by the PSoC peripheral driver library on the target */
+typedef uint8_t     uint8;
+typedef uint16_t    uint16;
+typedef uint32_t    uint32;
+typedef int8_t      int8;
+typedef int16_t     int16;
+typedef int32_t     int32;
+
+/* Macros used for byte level operations */
+#define CY_EINK_BYTE_SIZE      (uint8_t)(0x08u)
+#define CY_EINK_SINGLE_BYTE    (uint8_t)(0x01u)
+
+/* Depth of the asynchronous SPI transaction queue. Each E-INK data line takes
+   four CS-framed transactions (pixel data index, pixel data, OE index, OE data) */
+#define CY_EINK_SPI_QUEUE_SIZE     (uint8_t)(16u)
+
+/* Definitions of pin sates */
+#define CY_EINK_PIN_LOW        (uint8_t)(0x00u)
+#define CY_EINK_PIN_HIGH       (uint8_t)(0x01u)
+
+/* Display pins recorded by the capture */
+typedef enum
+{
+    CY_EINK_HOST_PIN_CS,
+    CY_EINK_HOST_PIN_RST,
+    CY_EINK_HOST_PIN_DISCHARGE,
+    CY_EINK_HOST_PIN_VCC,
+    CY_EINK_HOST_PIN_BORDER,
+    CY_EINK_HOST_PIN_IOEN,
+    CY_EINK_HOST_PIN_COUNT
+}   cy_eink_host_pin_t;
+
+/* Push the chip select pin to logic HIGH */
+#define CY_EINK_CsHigh         Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_CS, CY_EINK_PIN_HIGH)
+
+/* Pull the chip select pin to logic LOW */
+#define CY_EINK_CsLow          Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_CS, CY_EINK_PIN_LOW)
+
+/* Push the reset pin to logic HIGH */
+#define CY_EINK_RstHigh        Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_RST, CY_EINK_PIN_HIGH)
+
+/* Pull the reset pin to logic LOW */
+#define CY_EINK_RstLow         Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_RST, CY_EINK_PIN_LOW)
+
+/* Push the discharge pin to logic HIGH */
+#define CY_EINK_DischargeHigh  Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_DISCHARGE, CY_EINK_PIN_HIGH)
+
+/* Pull the discharge pin to logic LOW */
+#define CY_EINK_DischargeLow   Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_DISCHARGE, CY_EINK_PIN_LOW)
+
+/* Turn on the display by pushing the display enable pin to logic HIGH */
+#define CY_EINK_TurnOnVcc      Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_VCC, CY_EINK_PIN_HIGH)
+
+/* Turn off the display by pulling the display enable pin to logic LOW */
+#define CY_EINK_TurnOffVcc     Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_VCC, CY_EINK_PIN_LOW)
+
+/* Push the border pin to logic HIGH */
+#define CY_EINK_BorderHigh     Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_BORDER, CY_EINK_PIN_HIGH)
+
+/* Pull the border  pin to logic LOW */
+#define CY_EINK_BorderLow      Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_BORDER, CY_EINK_PIN_LOW)
+
+/* Pull the Enable I/O pin to logic LOW */
+#define CY_EINK_EnableIO       Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_IOEN, CY_EINK_PIN_LOW)
+
+/* Push the Enable I/O pin to logic HIGH */
+#define CY_EINK_DisableIO      Cy_EINK_HostWritePin(CY_EINK_HOST_PIN_IOEN, CY_EINK_PIN_HIGH)
+
+/* Delay in mS on the virtual clock */
+#define CY_EINK_Delay          Cy_EINK_HostDelay
+
+/* Delay of 10uS on the virtual clock */
+#define CY_EINK_Wait10uS       Cy_EINK_DelayUs(10u)
+
+/* Frequency of the E-INK timer. One tick of the timer is one microsecond */
+#define CY_EINK_TIMER_FREQUENCY    (uint32_t)(1000000u)
+#define CY_EINK_TICKS_PER_MS       (uint32_t)(CY_EINK_TIMER_FREQUENCY / 1000u)
+
+/* Functions used for E-INK display timing */
+bool        Cy_EINK_StartTimer(void);
+void        Cy_EINK_TimerInit(void);
+void        Cy_EINK_TimerStop(void);
+uint32_t    Cy_EINK_GetTimeTick(void);
+void        Cy_EINK_DelayUs(uint32_t delay);
+
+/* Functions used for E-INK driver communication */
+void 		CY_EINK_InitDriver(void);
+void        Cy_EINK_InitSPI(void);
+void        Cy_EINK_AttachSPI(void);
+void        Cy_EINK_DetachSPI(void);
+void        Cy_EINK_WriteSPI(uint8_t data);
+uint8_t     Cy_EINK_ReadSPI(void);
+uint8_t     Cy_EINK_WriteReadSPI(uint8_t data);
+bool        Cy_EINK_IsBusy(void);
+bool        Cy_EINK_WaitWhileBusy(uint32_t timeout);
+
+/* Functions used for asynchronous E-INK driver communication */
+bool        Cy_EINK_QueueSPIBuffer(uint8_t* header, uint8_t headerLength,
+                                   uint8_t* data, uint16_t dataLength);
+bool        Cy_EINK_WaitSPIQueue(uint8_t maxPending);
+
+/* Functions used by the E-INK benchmark */
+uint32_t    Cy_EINK_GetCycleCount(void);
+void        Cy_EINK_CountedCsLow(void);
+void        Cy_EINK_ResetSPICounters(void);
+void        Cy_EINK_GetSPICounters(uint32_t* bytes, uint32_t* transactions);
+
+/* Host functions behind the pin and delay macros */
+void        Cy_EINK_HostWritePin(cy_eink_host_pin_t pin, uint8_t level);
+void        Cy_EINK_HostDelay(uint32_t delay);
+
+#endif /* CY_EINK_INTERFACE_H */
+/* [] END OF FILE */